@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AdvPhysBakeAsset.h"
+
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void UAdvPhysBakeAsset::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Keep the payload out of the export so loading the asset itself stays cheap
+	Payload.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+	Payload.Serialize(Ar, this);
+}
+
+void UAdvPhysBakeAsset::SetRecordData(const FPhysRecordData& Data)
+{
+	if (!Data.Finished)
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString("Tried to store an unfinished bake."));
+		return;
+	}
+	
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes, true);
+	Writer << const_cast<FPhysRecordData&>(Data);
+
+	FScopeLock Lock(&PayloadLock);
+	Payload.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(Payload.Realloc(Bytes.Num()), Bytes.GetData(), Bytes.Num());
+	Payload.Unlock();
+
+	FrameCount = Data.FrameCount;
+	FrameInterval = Data.FrameInterval;
+	ObjectCount = Data.ObjectCount;
+	PayloadSize = Bytes.Num();
+	MarkPackageDirty();
+}
+
+FPhysRecordDataPtr UAdvPhysBakeAsset::LoadRecordData()
+{
+	FScopeLock Lock(&PayloadLock);
+	const int64 Size = Payload.GetBulkDataSize();
+	if (Size <= 0) return nullptr;
+
+	// Hand the payload over instead of keeping it next to the bake. Bulk data only lets go of it when it can load it
+	// from the package again, otherwise it stays and counts through GetResidentPayloadSize.
+	void* Bytes = nullptr;
+	Payload.GetCopy(&Bytes, true);
+	
+	auto Data = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	FMemoryReaderView Reader(MakeArrayView(static_cast<const uint8*>(Bytes), Size), true);
+	Reader << *Data;
+	FMemory::Free(Bytes);
+	return Data;
+}
+
+int64 UAdvPhysBakeAsset::GetResidentPayloadSize() const
+{
+	FScopeLock Lock(&PayloadLock);
+	return Payload.IsBulkDataLoaded() ? Payload.GetBulkDataSize() : 0;
+}
@@ -0,0 +1,268 @@
+#include "AdvPhysBakeBenchmarkCommandlet.h"
+
+#include "AdvPhysBakeProfile.h"
+#include "AdvPhysScene.h"
+#include "AdvPhysSyntheticScene.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PhysSimulator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAdvPhysBakeBenchmark, Log, All);
+
+struct FBakeBenchmarkSettings
+{
+	FString Shape = TEXT("box");
+	int FrameCount = 300;
+	float Interval = 1.0f / 60.0f;
+	int Substeps = 1;
+	bool bEnableSOD = false;
+	float HashCellSize = 100.0f;
+	bool bRecordImpacts = false;
+	bool bRecordIslands = false;
+	// Every scene is recorded once per profile, nullptr standing for the scene's own or PhysX defaults
+	TArray<UAdvPhysBakeProfile*> Profiles;
+};
+
+struct FBakeBenchmarkRun
+{
+	FString Name;
+	FString Profile;
+	int NumOfBodies = 0;
+	double Setup = 0.0;
+	double Total = 0.0;
+	PhysRecordTimings Timings;
+	uint64 BakeBytes = 0;
+	// Growth of the used physical memory of the process while recording
+	uint64 PeakRecordBytes = 0;
+	uint64 PeakProcessBytes = 0;
+};
+
+UAdvPhysBakeBenchmarkCommandlet::UAdvPhysBakeBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+static void RunRecord(PhysSimulator& Simulator, const FBakeBenchmarkSettings& Settings, FBakeBenchmarkRun& Run)
+{
+	Run.NumOfBodies = Simulator.ObservedBodies.size();
+	FPhysRecordData Data;
+	Data.bEnableSOD = Settings.bEnableSOD;
+	Data.HashWorldCenter = FVector::ZeroVector;
+	Data.HashCellSize = Settings.HashCellSize;
+	Simulator.Controller = nullptr;
+	Simulator.SetImpactRecording(Settings.bRecordImpacts, 1000.0f);
+	Simulator.SetIslandRecording(Settings.bRecordIslands);
+	Simulator.SetSubsteps(Settings.Substeps);
+
+	const uint64 BaseBytes = FPlatformMemory::GetStats().UsedPhysical;
+	const double Start = FPlatformTime::Seconds();
+	Simulator.StartRecord(&Data, Settings.Interval, Settings.FrameCount, -980.0f);
+	while (!Data.Finished)
+	{
+		const uint64 Used = FPlatformMemory::GetStats().UsedPhysical;
+		Run.PeakRecordBytes = FMath::Max(Run.PeakRecordBytes, Used > BaseBytes ? Used - BaseBytes : 0);
+		FPlatformProcess::Sleep(0.005f);
+	}
+	Run.Total = FPlatformTime::Seconds() - Start;
+	while (Simulator.IsRecording())
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	Run.Timings = Simulator.Timings;
+	Run.BakeBytes = Data.GetAllocatedSize();
+	Run.PeakProcessBytes = FPlatformMemory::GetStats().PeakUsedPhysical;
+	UE_LOG(LogAdvPhysBakeBenchmark, Display, TEXT("%s (%s): %d bodies, %.3fs setup, %.3fs record"),
+		*Run.Name, *Run.Profile, Run.NumOfBodies, Run.Setup, Run.Total);
+}
+
+static void BenchmarkSynthetic(int NumOfBodies, const FBakeBenchmarkSettings& Settings, TArray<FBakeBenchmarkRun>& OutRuns)
+{
+	FPhysSceneDesc Desc;
+	AdvPhysSyntheticScene::MakePiles(NumOfBodies, Settings.Shape, Desc);
+	for (const auto& Profile : Settings.Profiles)
+	{
+		FBakeBenchmarkRun Run;
+		Run.Name = FString::Printf(TEXT("%s-%d"), *Settings.Shape, NumOfBodies);
+		Run.Profile = Profile ? Profile->GetName() : TEXT("Default");
+
+		PhysSimulator Simulator;
+		Simulator.SetProfile(Profile ? Profile->Profile : FPhysBakeProfile());
+		Simulator.Initialize();
+		const double Start = FPlatformTime::Seconds();
+		Simulator.ImportScene(Desc);
+		Run.Setup = FPlatformTime::Seconds() - Start;
+		RunRecord(Simulator, Settings, Run);
+		OutRuns.Add(Run);
+		Simulator.Cleanup();
+	}
+}
+
+static void AddTagged(UWorld* World, FName Tag, bool bDynamic, bool bUseSimpleGeometry, EShapeType StaticShapeType, PhysSimulator& Simulator)
+{
+	if (Tag.IsNone()) return;
+	TArray<UStaticMeshComponent*> Comps;
+	for (const auto& Actor : World->PersistentLevel->Actors)
+	{
+		if (!Actor || !Actor->ActorHasTag(Tag)) continue;
+		Comps.Reset();
+		Actor->GetComponents<UStaticMeshComponent>(Comps);
+		for (const auto& Comp : Comps)
+		{
+			if (!Comp->GetStaticMesh()) continue;
+			if (bDynamic) Simulator.AddDynamicBody(Comp, bUseSimpleGeometry);
+			else Simulator.AddStaticBody(Comp, StaticShapeType);
+		}
+	}
+}
+
+// Records every AAdvPhysScene of the map with the objects its tags pick up, like AddTaggedObjects at BeginPlay
+static bool BenchmarkMap(const FString& MapPath, const FBakeBenchmarkSettings& Settings, TArray<FBakeBenchmarkRun>& OutRuns)
+{
+	UPackage* Package = LoadPackage(nullptr, *MapPath, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogAdvPhysBakeBenchmark, Error, TEXT("Could not load map %s"), *MapPath);
+		return false;
+	}
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+	World->InitWorld(UWorld::InitializationValues().AllowAudioPlayback(false).CreateNavigation(false).CreateAISystem(false));
+	World->UpdateWorldComponents(true, false);
+
+	for (const auto& Actor : World->PersistentLevel->Actors)
+	{
+		const auto Scene = Cast<AAdvPhysScene>(Actor);
+		if (!Scene) continue;
+
+		for (const auto& Profile : Settings.Profiles)
+		{
+			FBakeBenchmarkRun Run;
+			Run.Name = Scene->GetName();
+			const auto SceneProfile = Profile ? Profile : Scene->BakeProfile;
+			Run.Profile = SceneProfile ? SceneProfile->GetName() : TEXT("Default");
+			PhysSimulator Simulator;
+			Simulator.SetProfile(SceneProfile ? SceneProfile->Profile : FPhysBakeProfile());
+			Simulator.Initialize();
+			const double Start = FPlatformTime::Seconds();
+			AddTagged(World, Scene->DynamicTag, true, Scene->bUseSimpleGeometryForDynamicObj, Scene->StaticObjShapeType, Simulator);
+			AddTagged(World, Scene->StaticTag, false, Scene->bUseSimpleGeometryForDynamicObj, Scene->StaticObjShapeType, Simulator);
+			Run.Setup = FPlatformTime::Seconds() - Start;
+
+			FBakeBenchmarkSettings SceneSettings = Settings;
+			SceneSettings.bEnableSOD = Settings.bEnableSOD || Scene->bEnableSOD;
+			SceneSettings.HashCellSize = Scene->SODHashCellSize;
+			RunRecord(Simulator, SceneSettings, Run);
+			OutRuns.Add(Run);
+			Simulator.Cleanup();
+		}
+	}
+
+	World->CleanupWorld();
+	World->RemoveFromRoot();
+	return true;
+}
+
+static void WriteReports(const FString& BasePath, const FBakeBenchmarkSettings& Settings, const TArray<FBakeBenchmarkRun>& Runs)
+{
+	FString Csv = TEXT("name,profile,bodies,setup,total,cooking,events,simulate,fetch_results,contacts,readback,hashing,bake_bytes,peak_record_bytes,peak_process_bytes\n");
+	FString Json = FString::Printf(
+		TEXT("{\n  \"frames\": %d,\n  \"interval\": %f,\n  \"substeps\": %d,\n  \"sod\": %s,\n  \"shape\": \"%s\",\n  \"runs\": ["),
+		Settings.FrameCount, Settings.Interval, Settings.Substeps, Settings.bEnableSOD ? TEXT("true") : TEXT("false"), *Settings.Shape);
+
+	for (int i = 0; i < Runs.Num(); i++)
+	{
+		const auto& Run = Runs[i];
+		const auto& T = Run.Timings;
+		Csv += FString::Printf(TEXT("%s,%s,%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%llu,%llu,%llu\n"),
+			*Run.Name, *Run.Profile, Run.NumOfBodies, Run.Setup, Run.Total, T.Cooking, T.Events, T.Simulate, T.FetchResults, T.Contacts, T.Readback, T.Hashing,
+			Run.BakeBytes, Run.PeakRecordBytes, Run.PeakProcessBytes);
+		Json += FString::Printf(
+			TEXT("%s\n    { \"name\": \"%s\", \"profile\": \"%s\", \"bodies\": %d, \"setup\": %f, \"total\": %f, \"cooking\": %f, \"events\": %f, \"simulate\": %f, ")
+			TEXT("\"fetch_results\": %f, \"contacts\": %f, \"readback\": %f, \"hashing\": %f, \"bake_bytes\": %llu, \"peak_record_bytes\": %llu, \"peak_process_bytes\": %llu }"),
+			i > 0 ? TEXT(",") : TEXT(""), *Run.Name.ReplaceCharWithEscapedChar(), *Run.Profile.ReplaceCharWithEscapedChar(), Run.NumOfBodies, Run.Setup, Run.Total, T.Cooking, T.Events, T.Simulate,
+			T.FetchResults, T.Contacts, T.Readback, T.Hashing, Run.BakeBytes, Run.PeakRecordBytes, Run.PeakProcessBytes);
+	}
+	Json += TEXT("\n  ]\n}\n");
+
+	FFileHelper::SaveStringToFile(Csv, *(BasePath + TEXT(".csv")));
+	FFileHelper::SaveStringToFile(Json, *(BasePath + TEXT(".json")));
+	UE_LOG(LogAdvPhysBakeBenchmark, Display, TEXT("Wrote %s.csv and .json"), *BasePath);
+}
+
+int32 UAdvPhysBakeBenchmarkCommandlet::Main(const FString& Params)
+{
+	FBakeBenchmarkSettings Settings;
+	FParse::Value(*Params, TEXT("shape="), Settings.Shape);
+	FParse::Value(*Params, TEXT("frames="), Settings.FrameCount);
+	FParse::Value(*Params, TEXT("interval="), Settings.Interval);
+	FParse::Value(*Params, TEXT("substeps="), Settings.Substeps);
+	FParse::Value(*Params, TEXT("cellsize="), Settings.HashCellSize);
+	Settings.bEnableSOD = FParse::Param(*Params, TEXT("sod"));
+	Settings.bRecordImpacts = FParse::Param(*Params, TEXT("impacts"));
+	Settings.bRecordIslands = FParse::Param(*Params, TEXT("islands"));
+	Settings.Shape.ToLowerInline();
+	if (Settings.FrameCount <= 0 || Settings.Interval <= 0.0f)
+	{
+		UE_LOG(LogAdvPhysBakeBenchmark, Error, TEXT("-frames and -interval must be positive"));
+		return 1;
+	}
+
+	int32 Threads = 0;
+	if (FParse::Value(*Params, TEXT("threads="), Threads))
+	{
+		PhysSimulator::DispatcherThreads = FMath::Max(1, Threads);
+	}
+
+	FString Profiles;
+	if (FParse::Value(*Params, TEXT("profiles="), Profiles, false))
+	{
+		TArray<FString> Paths;
+		Profiles.ParseIntoArray(Paths, TEXT(","));
+		for (const auto& Path : Paths)
+		{
+			UAdvPhysBakeProfile* Profile = LoadObject<UAdvPhysBakeProfile>(nullptr, *Path);
+			if (!Profile)
+			{
+				UE_LOG(LogAdvPhysBakeBenchmark, Error, TEXT("Could not load bake profile %s"), *Path);
+				return 1;
+			}
+			Profile->AddToRoot();
+			Settings.Profiles.Add(Profile);
+		}
+	}
+	if (Settings.Profiles.Num() == 0)
+	{
+		Settings.Profiles.Add(nullptr);
+	}
+
+	TArray<FBakeBenchmarkRun> Runs;
+	FString MapPath;
+	if (FParse::Value(*Params, TEXT("map="), MapPath))
+	{
+		if (!BenchmarkMap(MapPath, Settings, Runs)) return 1;
+	}
+	else
+	{
+		FString Counts = TEXT("100,400,1600");
+		FParse::Value(*Params, TEXT("counts="), Counts, false);
+		TArray<FString> Entries;
+		Counts.ParseIntoArray(Entries, TEXT(","));
+		for (const auto& Entry : Entries)
+		{
+			const int NumOfBodies = FCString::Atoi(*Entry);
+			if (NumOfBodies > 0) BenchmarkSynthetic(NumOfBodies, Settings, Runs);
+		}
+	}
+
+	FString BasePath = FPaths::ProjectSavedDir() / TEXT("AdvPhysBenchmarks") / (TEXT("BakeBenchmark-") + FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("out="), BasePath);
+	WriteReports(BasePath, Settings, Runs);
+	return 0;
+}
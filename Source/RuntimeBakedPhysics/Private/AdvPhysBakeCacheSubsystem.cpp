@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AdvPhysBakeCacheSubsystem.h"
+
+#include "AdvPhysScene.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarBakeMemoryBudgetMB(
+	TEXT("AdvPhys.BakeMemoryBudgetMB"),
+	512,
+	TEXT("Megabytes of bake data kept resident per world, idle bakes beyond it are evicted. <= 0 disables eviction."));
+
+void UAdvPhysBakeCacheSubsystem::NotifyBakeResident(AAdvPhysScene* Scene)
+{
+	Touch(Scene);
+	EnforceBudget();
+}
+
+void UAdvPhysBakeCacheSubsystem::Touch(AAdvPhysScene* Scene)
+{
+	LastUsedTimes.Add(Scene, GetWorld()->GetTimeSeconds());
+}
+
+void UAdvPhysBakeCacheSubsystem::Remove(AAdvPhysScene* Scene)
+{
+	LastUsedTimes.Remove(Scene);
+}
+
+void UAdvPhysBakeCacheSubsystem::EnforceBudget()
+{
+	const int64 Budget = GetBudgetBytes();
+	if (Budget <= 0) return;
+	
+	int64 Resident = GetResidentBytes();
+	if (Resident <= Budget) return;
+
+	TArray<TPair<double, AAdvPhysScene*>> Candidates;
+	for (const auto& Entry : LastUsedTimes)
+	{
+		AAdvPhysScene* Scene = Entry.Key.Get();
+		if (!Scene || !Scene->CanEvictBake()) continue;
+		Candidates.Add({ Entry.Value, Scene });
+	}
+	Candidates.Sort([](const TPair<double, AAdvPhysScene*>& A, const TPair<double, AAdvPhysScene*>& B) { return A.Key < B.Key; });
+
+	int NumOfEvicted = 0;
+	for (const auto& Candidate : Candidates)
+	{
+		if (Resident <= Budget) break;
+		Resident -= Candidate.Value->GetBakeMemorySize() - Candidate.Value->GetBakePayloadSize();
+		Candidate.Value->EvictBake();
+		NumOfEvicted++;
+	}
+	if (NumOfEvicted == 0) return;
+
+	FMessageLog("AdvPhysScene").Info(
+		FText::Format(
+			FText::FromString("Evicted {0} bakes, {1} of {2} bytes resident."),
+			NumOfEvicted,
+			Resident,
+			Budget
+		)
+	);
+}
+
+int64 UAdvPhysBakeCacheSubsystem::GetResidentBytes() const
+{
+	TSet<const void*> Counted;
+	int64 Bytes = 0;
+	for (const auto& Entry : LastUsedTimes)
+	{
+		const AAdvPhysScene* Scene = Entry.Key.Get();
+		if (!Scene) continue;
+		if (Scene->IsBakeEvicted())
+		{
+			Bytes += Scene->GetBakePayloadSize();
+			continue;
+		}
+		bool bAlreadyCounted;
+		Counted.Add(Scene->GetBakeIdentity(), &bAlreadyCounted);
+		if (bAlreadyCounted) continue;
+		Bytes += Scene->GetBakeMemorySize();
+	}
+	return Bytes;
+}
+
+int64 UAdvPhysBakeCacheSubsystem::GetBudgetBytes() const
+{
+	return static_cast<int64>(CVarBakeMemoryBudgetMB.GetValueOnGameThread()) * 1024 * 1024;
+}
@@ -0,0 +1,58 @@
+#include "AdvPhysBakeCompare.h"
+
+#include "Hash/CityHash.h"
+
+uint64 AdvPhysBakeCompare::HashFrame(const FPhysRecordData& Data, int Frame)
+{
+	return CityHash64(reinterpret_cast<const char*>(&Data.ObjLocRot[Frame * Data.ObjectCount]),
+		Data.ObjectCount * sizeof(FPhysObjLocRot));
+}
+
+FPhysBakeDifference AdvPhysBakeCompare::Compare(const FPhysRecordData& A, const FPhysRecordData& B, float LocationTolerance, float RotationTolerance)
+{
+	FPhysBakeDifference Result;
+	if (A.FrameCount != B.FrameCount || A.ObjectCount != B.ObjectCount)
+	{
+		Result.Mismatch = FString::Printf(TEXT("%d frames of %d objects against %d frames of %d objects"),
+			A.FrameCount, A.ObjectCount, B.FrameCount, B.ObjectCount);
+		return Result;
+	}
+	if (A.ObjectIds != B.ObjectIds)
+	{
+		Result.Mismatch = TEXT("Objects are different or in a different order");
+		return Result;
+	}
+	if (A.FrameInterval != B.FrameInterval)
+	{
+		Result.Mismatch = FString::Printf(TEXT("Frame interval %f against %f"), A.FrameInterval, B.FrameInterval);
+		return Result;
+	}
+
+	// Equal hashes only prove equal frames when no difference is tolerated
+	const bool bExact = LocationTolerance <= 0.0f && RotationTolerance <= 0.0f;
+	const bool bUseHashes = bExact && A.FrameHashes.Num() == A.FrameCount && B.FrameHashes.Num() == B.FrameCount;
+	const int NumOfObjects = A.ObjectCount;
+	for (int Frame = 0; Frame < A.FrameCount; Frame++)
+	{
+		if (bUseHashes && A.FrameHashes[Frame] == B.FrameHashes[Frame]) continue;
+		for (int ObjIndex = 0; ObjIndex < NumOfObjects; ObjIndex++)
+		{
+			const auto& PoseA = A.ObjLocRot[Frame * NumOfObjects + ObjIndex];
+			const auto& PoseB = B.ObjLocRot[Frame * NumOfObjects + ObjIndex];
+			const float LocationError = FVector::Dist(PoseA.Location, PoseB.Location);
+			const float RotationError = FMath::RadiansToDegrees(PoseA.Rotation.Quaternion().AngularDistance(PoseB.Rotation.Quaternion()));
+			const bool bDiffers = bExact
+				? PoseA.Location != PoseB.Location || PoseA.Rotation != PoseB.Rotation
+				: LocationError > LocationTolerance || RotationError > RotationTolerance;
+			if (!bDiffers) continue;
+
+			Result.Frame = Frame;
+			Result.ObjIndex = ObjIndex;
+			Result.ObjectId = A.ObjectIds.IsValidIndex(ObjIndex) ? A.ObjectIds[ObjIndex] : NAME_None;
+			Result.LocationError = LocationError;
+			Result.RotationError = RotationError;
+			return Result;
+		}
+	}
+	return Result;
+}
@@ -0,0 +1,72 @@
+#include "AdvPhysBakeCompareCommandlet.h"
+
+#include "AdvPhysBakeAsset.h"
+#include "AdvPhysBakeCompare.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAdvPhysBakeCompare, Log, All);
+
+UAdvPhysBakeCompareCommandlet::UAdvPhysBakeCompareCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+static FPhysRecordDataPtr LoadBake(const FString& Path)
+{
+	UAdvPhysBakeAsset* Asset = LoadObject<UAdvPhysBakeAsset>(nullptr, *Path);
+	if (!Asset)
+	{
+		UE_LOG(LogAdvPhysBakeCompare, Error, TEXT("Could not load bake asset %s"), *Path);
+		return nullptr;
+	}
+	FPhysRecordDataPtr Data = Asset->LoadRecordData();
+	if (!Data.IsValid())
+	{
+		UE_LOG(LogAdvPhysBakeCompare, Error, TEXT("Bake asset %s has no payload"), *Path);
+	}
+	return Data;
+}
+
+int32 UAdvPhysBakeCompareCommandlet::Main(const FString& Params)
+{
+	FString PathA, PathB;
+	// Units and degrees, compared exactly if both are 0
+	float LocationTolerance = 0.0f;
+	float RotationTolerance = 0.0f;
+	FParse::Value(*Params, TEXT("a="), PathA);
+	FParse::Value(*Params, TEXT("b="), PathB);
+	FParse::Value(*Params, TEXT("loctol="), LocationTolerance);
+	FParse::Value(*Params, TEXT("rottol="), RotationTolerance);
+	if (PathA.IsEmpty() || PathB.IsEmpty())
+	{
+		UE_LOG(LogAdvPhysBakeCompare, Error, TEXT("Usage: -run=AdvPhysBakeCompare -a=BakeAsset -b=BakeAsset [-loctol=0] [-rottol=0]"));
+		return 1;
+	}
+
+	const FPhysRecordDataPtr A = LoadBake(PathA);
+	const FPhysRecordDataPtr B = LoadBake(PathB);
+	if (!A.IsValid() || !B.IsValid()) return 1;
+
+	if (A->FrameHashes.Num() == 0 || B->FrameHashes.Num() == 0)
+	{
+		UE_LOG(LogAdvPhysBakeCompare, Display, TEXT("Frame hashes missing, comparing every pose"));
+	}
+
+	const FPhysBakeDifference Difference = AdvPhysBakeCompare::Compare(*A, *B, LocationTolerance, RotationTolerance);
+	if (!Difference.Mismatch.IsEmpty())
+	{
+		UE_LOG(LogAdvPhysBakeCompare, Error, TEXT("Bakes cannot be compared: %s"), *Difference.Mismatch);
+		return 1;
+	}
+	if (Difference.IsIdentical())
+	{
+		UE_LOG(LogAdvPhysBakeCompare, Display, TEXT("Bakes are identical over %d frames of %d objects"), A->FrameCount, A->ObjectCount);
+		return 0;
+	}
+	UE_LOG(LogAdvPhysBakeCompare, Warning, TEXT("Bakes diverge at frame %d (%.3fs), object %d (%s): %f units, %f degrees apart"),
+		Difference.Frame, Difference.Frame * A->FrameInterval, Difference.ObjIndex, *Difference.ObjectId.ToString(),
+		Difference.LocationError, Difference.RotationError);
+	return 1;
+}
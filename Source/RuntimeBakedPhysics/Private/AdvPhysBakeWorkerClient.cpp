@@ -0,0 +1,136 @@
+#include "AdvPhysBakeWorkerClient.h"
+
+#include "AdvPhysBakeWorkerProtocol.h"
+#include "Async/Async.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+
+FAdvPhysBakeWorkerClient::~FAdvPhysBakeWorkerClient()
+{
+	Stop();
+}
+
+bool FAdvPhysBakeWorkerClient::Start(const FString& Address, FPhysSceneDesc Desc, FPhysRecordDataPtr Destination)
+{
+	Stop();
+	SetError(FString());
+
+	FIPv4Endpoint Endpoint;
+	if (!FIPv4Endpoint::Parse(Address, Endpoint))
+	{
+		SetError(FString::Printf(TEXT("Invalid bake worker address %s"), *Address));
+		return false;
+	}
+
+	ISocketSubsystem* Sockets = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	Socket = Sockets->CreateSocket(NAME_Stream, TEXT("AdvPhysBakeClient"));
+	if (!Socket || !Socket->Connect(*Endpoint.ToInternetAddr()))
+	{
+		SetError(FString::Printf(TEXT("No bake worker at %s"), *Address));
+		if (Socket) Sockets->DestroySocket(Socket);
+		Socket = nullptr;
+		return false;
+	}
+
+	TArray<uint8> Job;
+	FMemoryWriter Writer(Job);
+	Writer << Desc;
+
+	bCancel = false;
+	Task = Async(EAsyncExecution::Thread, [this, Job = MoveTemp(Job), Destination]() mutable
+	{
+		RunInternal(MoveTemp(Job), MoveTemp(Destination));
+	});
+	return true;
+}
+
+void FAdvPhysBakeWorkerClient::Stop()
+{
+	if (Task.IsValid())
+	{
+		bCancel = true;
+		Task.Wait();
+		Task = TFuture<void>();
+	}
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+}
+
+bool FAdvPhysBakeWorkerClient::IsRunning() const
+{
+	return Task.IsValid() && !Task.IsReady();
+}
+
+FString FAdvPhysBakeWorkerClient::GetError() const
+{
+	FScopeLock Lock(&ErrorLock);
+	return Error;
+}
+
+void FAdvPhysBakeWorkerClient::SetError(const FString& Reason)
+{
+	FScopeLock Lock(&ErrorLock);
+	Error = Reason;
+}
+
+void FAdvPhysBakeWorkerClient::RunInternal(TArray<uint8> Job, FPhysRecordDataPtr Destination)
+{
+	if (!AdvPhysBakeWorkerProtocol::Send(Socket, EAdvPhysBakeMessage::Job, Job))
+	{
+		SetError(TEXT("Could not send the scene to the bake worker"));
+		return;
+	}
+
+	EAdvPhysBakeMessage Type;
+	TArray<uint8> Payload;
+	bool bHasHeader = false;
+	while (AdvPhysBakeWorkerProtocol::Receive(Socket, Type, Payload, &bCancel))
+	{
+		FMemoryReader Reader(Payload);
+		switch (Type)
+		{
+		case EAdvPhysBakeMessage::Header:
+			AdvPhysBakeWorkerProtocol::SerializeHeader(Reader, *Destination);
+			bHasHeader = !Reader.IsError();
+			break;
+		case EAdvPhysBakeMessage::Frames:
+			if (!bHasHeader) Reader.SetError();
+			else AdvPhysBakeWorkerProtocol::SerializeFrames(Reader, *Destination, 0, 0);
+			break;
+		case EAdvPhysBakeMessage::Finished:
+			if (!bHasHeader)
+			{
+				Reader.SetError();
+				break;
+			}
+			AdvPhysBakeWorkerProtocol::SerializeFinished(Reader, *Destination);
+			return;
+		case EAdvPhysBakeMessage::Failed:
+			{
+				FString Reason;
+				Reader << Reason;
+				SetError(Reason);
+				return;
+			}
+		default:
+			Reader.SetError();
+		}
+
+		if (Reader.IsError())
+		{
+			SetError(TEXT("Malformed message from the bake worker"));
+			return;
+		}
+	}
+	if (!bCancel)
+	{
+		SetError(TEXT("Lost the connection to the bake worker"));
+	}
+}
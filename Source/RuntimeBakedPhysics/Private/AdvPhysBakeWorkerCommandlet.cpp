@@ -0,0 +1,244 @@
+#include "AdvPhysBakeWorkerCommandlet.h"
+
+#include "AdvPhysBakeWorkerProtocol.h"
+#include "AdvPhysEvent_ForceField.h"
+#include "Async/Async.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "PhysSimulator.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAdvPhysBakeWorker, Log, All);
+
+// Frames sent per message at most, so clients see progress on long bakes
+#define FRAMES_PER_MESSAGE 64
+// Connections that do not send their job within this many seconds are dropped
+#define JOB_RECEIVE_TIMEOUT 10.0f
+
+struct FBakeWorkerJob
+{
+	FSocket* Socket = nullptr;
+	// The job message is read off the pump loop, which keeps streaming the frames of running jobs meanwhile
+	TFuture<bool> Received;
+	TAtomic<bool> bCancelReceive { false };
+	EAdvPhysBakeMessage ReceivedType;
+	TArray<uint8> ReceivedPayload;
+	bool bStarted = false;
+	PhysSimulator Simulator;
+	FPhysRecordDataPtr Data;
+	TArray<AAdvPhysEventBase*> Events;
+	int SentFrames = 0;
+	double StartTime = 0.0;
+};
+
+UAdvPhysBakeWorkerCommandlet::UAdvPhysBakeWorkerCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+static void FailJob(FBakeWorkerJob& Job, const FString& Reason)
+{
+	UE_LOG(LogAdvPhysBakeWorker, Warning, TEXT("Job failed: %s"), *Reason);
+	TArray<uint8> Payload;
+	FMemoryWriter Writer(Payload);
+	FString Message = Reason;
+	Writer << Message;
+	AdvPhysBakeWorkerProtocol::Send(Job.Socket, EAdvPhysBakeMessage::Failed, Payload);
+}
+
+static void ReceiveJob(FBakeWorkerJob& Job)
+{
+	Job.Received = Async(EAsyncExecution::ThreadPool, [&Job]()
+	{
+		return AdvPhysBakeWorkerProtocol::Receive(Job.Socket, Job.ReceivedType, Job.ReceivedPayload, &Job.bCancelReceive, JOB_RECEIVE_TIMEOUT);
+	});
+}
+
+// Called once the job message arrived
+static bool StartJob(UWorld* World, FBakeWorkerJob& Job)
+{
+	if (!Job.Received.Get() || Job.ReceivedType != EAdvPhysBakeMessage::Job)
+	{
+		UE_LOG(LogAdvPhysBakeWorker, Warning, TEXT("Dropped a connection without a job"));
+		return false;
+	}
+
+	TArray<uint8> Payload = MoveTemp(Job.ReceivedPayload);
+	FPhysSceneDesc Desc;
+	FMemoryReader Reader(Payload);
+	Reader << Desc;
+	if (Reader.IsError() || Desc.FrameCount <= 0 || Desc.FrameInterval <= 0.0f)
+	{
+		FailJob(Job, TEXT("Invalid scene description"));
+		return false;
+	}
+
+	Job.Simulator.Controller = nullptr;
+	Job.Simulator.SetProfile(Desc.Profile);
+	Job.Simulator.SetDeterministic(Desc.bDeterministic);
+	Job.Simulator.Initialize();
+	Job.Simulator.ImportScene(Desc);
+	if (Job.Simulator.ObservedBodies.size() != Desc.ObjectIds.Num())
+	{
+		FailJob(Job, TEXT("Object ids do not match the dynamic bodies"));
+		return false;
+	}
+
+	for (const auto& EventDesc : Desc.Events)
+	{
+		if (const auto Event = AAdvPhysEventBase::SpawnFromDesc(World, EventDesc))
+		{
+			Job.Events.Add(Event);
+		}
+	}
+	Job.Simulator.SetEventTimeline(MakeShared<const FPhysEventTimeline, ESPMode::ThreadSafe>(Job.Events, Desc.FrameInterval, Desc.FrameCount));
+	for (const auto& Event : Job.Events)
+	{
+		if (const auto Field = Cast<AAdvPhysEvent_ForceField>(Event))
+		{
+			Job.Simulator.AddForceField(Field, Desc.FrameInterval, Desc.FrameCount);
+		}
+	}
+
+	Job.Data = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	Job.Data->bEnableSOD = Desc.bEnableSOD;
+	Job.Data->Origin = Desc.Origin;
+	Job.Data->HashWorldCenter = Desc.HashWorldCenter;
+	Job.Data->HashCellSize = Desc.HashCellSize;
+	Job.Data->ObjectIds = Desc.ObjectIds;
+	Job.Simulator.SetImpactRecording(Desc.bRecordImpacts, Desc.ImpactImpulseThreshold);
+	Job.Simulator.SetIslandRecording(Desc.bRecordIslands);
+	Job.Simulator.SetTelemetryRecording(Desc.bRecordTelemetry);
+	Job.Simulator.SetStateHashRecording(Desc.bRecordStateHashes);
+	Job.Simulator.StartRecord(Job.Data.Get(), Desc.FrameInterval, Desc.FrameCount, Desc.GravityZ);
+	Job.StartTime = FPlatformTime::Seconds();
+
+	Payload.Reset();
+	FMemoryWriter Writer(Payload);
+	AdvPhysBakeWorkerProtocol::SerializeHeader(Writer, *Job.Data);
+	UE_LOG(LogAdvPhysBakeWorker, Display, TEXT("Baking %d objects, %d frames"), Job.Data->ObjectCount, Job.Data->FrameCount);
+	return AdvPhysBakeWorkerProtocol::Send(Job.Socket, EAdvPhysBakeMessage::Header, Payload);
+}
+
+// Sends the frames recorded since the last call, false once the job is over
+static bool PumpJob(FBakeWorkerJob& Job)
+{
+	auto& Data = *Job.Data;
+	const bool bFinished = Data.Finished;
+	// Progress is written after the whole frame, so every frame it counts is complete
+	const int RecordedFrames = bFinished ? Data.FrameCount : FMath::FloorToInt(Data.Progress * Data.FrameCount + 0.5f);
+
+	TArray<uint8> Payload;
+	while (Job.SentFrames < RecordedFrames)
+	{
+		const int NumOfFrames = FMath::Min(RecordedFrames - Job.SentFrames, FRAMES_PER_MESSAGE);
+		Payload.Reset();
+		FMemoryWriter Writer(Payload);
+		AdvPhysBakeWorkerProtocol::SerializeFrames(Writer, Data, Job.SentFrames, NumOfFrames);
+		if (!AdvPhysBakeWorkerProtocol::Send(Job.Socket, EAdvPhysBakeMessage::Frames, Payload)) return false;
+		Job.SentFrames += NumOfFrames;
+	}
+	if (!bFinished) return true;
+
+	Payload.Reset();
+	FMemoryWriter Writer(Payload);
+	AdvPhysBakeWorkerProtocol::SerializeFinished(Writer, Data);
+	AdvPhysBakeWorkerProtocol::Send(Job.Socket, EAdvPhysBakeMessage::Finished, Payload);
+	UE_LOG(LogAdvPhysBakeWorker, Display, TEXT("Baked %d frames in %.2fs"), Data.FrameCount, FPlatformTime::Seconds() - Job.StartTime);
+	return false;
+}
+
+static void EndJob(FBakeWorkerJob& Job)
+{
+	if (Job.Received.IsValid())
+	{
+		Job.bCancelReceive = true;
+		Job.Received.Wait();
+	}
+	Job.Simulator.StopRecordAndWait();
+	if (Job.Simulator.IsInitialized())
+	{
+		Job.Simulator.FreeEvents();
+		Job.Simulator.Cleanup();
+	}
+	for (const auto& Event : Job.Events)
+	{
+		Event->Destroy();
+	}
+	Job.Socket->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Job.Socket);
+}
+
+int32 UAdvPhysBakeWorkerCommandlet::Main(const FString& Params)
+{
+	int32 Port = ADVPHYS_BAKE_WORKER_DEFAULT_PORT;
+	FParse::Value(*Params, TEXT("port="), Port);
+	// Jobs record on threads of their own, the rest of the cores go to the PhysX dispatcher they all share
+	int32 Threads = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	FParse::Value(*Params, TEXT("threads="), Threads);
+	PhysSimulator::DispatcherThreads = FMath::Max(1, Threads);
+	const bool bOnce = FParse::Param(*Params, TEXT("once"));
+
+	FSocket* Listener = FTcpSocketBuilder(TEXT("AdvPhysBakeWorker"))
+		.AsReusable()
+		.BoundToEndpoint(FIPv4Endpoint(FIPv4Address::InternalLoopback, Port))
+		.Listening(16)
+		.Build();
+	if (!Listener)
+	{
+		UE_LOG(LogAdvPhysBakeWorker, Error, TEXT("Could not listen on port %d"), Port);
+		return 1;
+	}
+	UE_LOG(LogAdvPhysBakeWorker, Display, TEXT("Listening on port %d, %d dispatcher threads shared by all jobs"), Port, PhysSimulator::DispatcherThreads);
+
+	// Event actors of the jobs live in a world of their own
+	UWorld* World = UWorld::CreateWorld(EWorldType::Inactive, false);
+
+	TArray<TUniquePtr<FBakeWorkerJob>> Jobs;
+	bool bHadJob = false;
+	while (!IsEngineExitRequested() && !(bOnce && bHadJob && Jobs.Num() == 0))
+	{
+		bool bPending = false;
+		const FTimespan WaitTime = FTimespan::FromMilliseconds(Jobs.Num() > 0 ? 10 : 500);
+		if (Listener->WaitForPendingConnection(bPending, WaitTime) && bPending)
+		{
+			if (FSocket* Socket = Listener->Accept(TEXT("AdvPhysBakeJob")))
+			{
+				auto Job = MakeUnique<FBakeWorkerJob>();
+				Job->Socket = Socket;
+				bHadJob = true;
+				ReceiveJob(*Job);
+				Jobs.Add(MoveTemp(Job));
+			}
+		}
+
+		for (int i = Jobs.Num() - 1; i >= 0; i--)
+		{
+			auto& Job = *Jobs[i];
+			if (!Job.bStarted)
+			{
+				if (!Job.Received.IsReady()) continue;
+				Job.bStarted = StartJob(World, Job);
+				if (Job.bStarted) continue;
+			}
+			else if (PumpJob(Job)) continue;
+			EndJob(*Jobs[i]);
+			Jobs.RemoveAt(i);
+		}
+	}
+
+	for (const auto& Job : Jobs)
+	{
+		EndJob(*Job);
+	}
+	World->DestroyWorld(false);
+	Listener->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Listener);
+	return 0;
+}
@@ -0,0 +1,172 @@
+#include "AdvPhysBakeWorkerProtocol.h"
+
+#include "AdvPhysSODKernel.h"
+#include "Sockets.h"
+
+// Larger payloads are taken for a corrupt stream
+#define MAX_MESSAGE_SIZE (1 << 30)
+// Headers laying out more frames times objects are taken for a corrupt stream, keeps every track within int32 indices
+#define MAX_BAKE_ENTRIES (1 << 26)
+
+bool AdvPhysBakeWorkerProtocol::Send(FSocket* Socket, EAdvPhysBakeMessage Type, const TArray<uint8>& Payload)
+{
+	uint8 Header[5];
+	Header[0] = static_cast<uint8>(Type);
+	const int32 Size = Payload.Num();
+	FMemory::Memcpy(&Header[1], &Size, sizeof(Size));
+
+	const auto SendAll = [Socket](const uint8* Data, int32 Count)
+	{
+		while (Count > 0)
+		{
+			int32 Sent = 0;
+			if (!Socket->Send(Data, Count, Sent) || Sent <= 0) return false;
+			Data += Sent;
+			Count -= Sent;
+		}
+		return true;
+	};
+	return SendAll(Header, sizeof(Header)) && SendAll(Payload.GetData(), Size);
+}
+
+bool AdvPhysBakeWorkerProtocol::Receive(FSocket* Socket, EAdvPhysBakeMessage& OutType, TArray<uint8>& OutPayload, const TAtomic<bool>* bCancel, float Timeout)
+{
+	const double Deadline = Timeout > 0.0f ? FPlatformTime::Seconds() + Timeout : 0.0;
+	uint8 Header[5];
+	if (!ReceiveBytes(Socket, Header, sizeof(Header), bCancel, Deadline)) return false;
+
+	int32 Size;
+	FMemory::Memcpy(&Size, &Header[1], sizeof(Size));
+	if (Header[0] > static_cast<uint8>(EAdvPhysBakeMessage::Failed) || Size < 0 || Size > MAX_MESSAGE_SIZE) return false;
+
+	OutType = static_cast<EAdvPhysBakeMessage>(Header[0]);
+	OutPayload.SetNumUninitialized(Size);
+	return ReceiveBytes(Socket, OutPayload.GetData(), Size, bCancel, Deadline);
+}
+
+bool AdvPhysBakeWorkerProtocol::ReceiveBytes(FSocket* Socket, uint8* Data, int32 Size, const TAtomic<bool>* bCancel, double Deadline)
+{
+	while (Size > 0)
+	{
+		if (bCancel && *bCancel) return false;
+		if (Deadline > 0.0 && FPlatformTime::Seconds() > Deadline) return false;
+		// Waits in short steps so cancelling does not depend on the other side
+		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(100))) continue;
+
+		int32 Read = 0;
+		if (!Socket->Recv(Data, Size, Read) || Read <= 0) return false;
+		Data += Read;
+		Size -= Read;
+	}
+	return true;
+}
+
+void AdvPhysBakeWorkerProtocol::SerializeHeader(FArchive& Ar, FPhysRecordData& Data)
+{
+	Ar << Data.FrameCount << Data.FrameInterval << Data.ObjectCount << Data.bEnableSOD;
+	Ar << Data.Origin << Data.HashWorldCenter << Data.HashCellSize;
+	Ar << Data.ObjectIds;
+	Ar << Data.SODSoAStride;
+	bool bHasIslands = Data.ObjIsland.Num() > 0;
+	bool bHasTelemetry = Data.Telemetry.Num() > 0;
+	bool bHasHashes = Data.FrameHashes.Num() > 0;
+	Ar << bHasIslands << bHasTelemetry << bHasHashes;
+
+	if (!Ar.IsLoading() || Ar.IsError()) return;
+	// Checked before anything is allocated from them, the counts come straight from the socket
+	if (Data.FrameCount <= 0 || Data.ObjectCount < 0 || Data.ObjectIds.Num() != Data.ObjectCount
+		|| static_cast<int64>(Data.FrameCount) * Data.ObjectCount > MAX_BAKE_ENTRIES
+		|| (Data.bEnableSOD && Data.SODSoAStride != AdvPhysSODKernel::GetStride(Data.ObjectCount)))
+	{
+		Ar.SetError();
+		return;
+	}
+	const int NumOfEntries = Data.FrameCount * Data.ObjectCount;
+	Data.Finished = false;
+	Data.Progress = 0.0f;
+	Data.ObjLocRot.Empty();
+	Data.ObjLocRot.AddZeroed(NumOfEntries);
+	Data.ObjSOD.Empty();
+	Data.ObjSODSoA.Empty();
+	if (Data.bEnableSOD)
+	{
+		Data.ObjSOD.AddZeroed(NumOfEntries);
+		Data.ObjSODSoA.AddZeroed(Data.FrameCount * SOD_SOA_PLANES * Data.SODSoAStride);
+	}
+	Data.ObjIsland.Empty();
+	if (bHasIslands)
+	{
+		Data.ObjIsland.AddZeroed(NumOfEntries);
+	}
+	Data.Telemetry.Empty();
+	if (bHasTelemetry)
+	{
+		Data.Telemetry.AddZeroed(Data.FrameCount);
+	}
+	Data.FrameHashes.Empty();
+	if (bHasHashes)
+	{
+		Data.FrameHashes.AddZeroed(Data.FrameCount);
+	}
+	Data.Impacts.Empty();
+	Data.ImpactFrameStarts.Empty();
+}
+
+void AdvPhysBakeWorkerProtocol::SerializeFrames(FArchive& Ar, FPhysRecordData& Data, int FirstFrame, int NumOfFrames)
+{
+	Ar << FirstFrame << NumOfFrames;
+	if (FirstFrame < 0 || NumOfFrames < 0 || FirstFrame + NumOfFrames > Data.FrameCount)
+	{
+		Ar.SetError();
+		return;
+	}
+	if (NumOfFrames == 0) return;
+
+	const int First = FirstFrame * Data.ObjectCount;
+	const int Num = NumOfFrames * Data.ObjectCount;
+	for (int i = First; i < First + Num; i++)
+	{
+		Ar << Data.ObjLocRot[i];
+	}
+	if (Data.bEnableSOD)
+	{
+		for (int i = First; i < First + Num; i++)
+		{
+			Ar << Data.ObjSOD[i];
+		}
+		const int FrameFloats = SOD_SOA_PLANES * Data.SODSoAStride;
+		Ar.Serialize(&Data.ObjSODSoA[FirstFrame * FrameFloats], NumOfFrames * FrameFloats * sizeof(float));
+	}
+	if (Data.ObjIsland.Num() > 0)
+	{
+		Ar.Serialize(&Data.ObjIsland[First], Num * sizeof(int));
+	}
+	if (Data.Telemetry.Num() > 0)
+	{
+		for (int i = FirstFrame; i < FirstFrame + NumOfFrames; i++)
+		{
+			Ar << Data.Telemetry[i];
+		}
+	}
+	if (Data.FrameHashes.Num() > 0)
+	{
+		Ar.Serialize(&Data.FrameHashes[FirstFrame], NumOfFrames * sizeof(uint64));
+	}
+
+	if (Ar.IsLoading())
+	{
+		Data.Progress = static_cast<float>(FirstFrame + NumOfFrames) / Data.FrameCount;
+	}
+}
+
+void AdvPhysBakeWorkerProtocol::SerializeFinished(FArchive& Ar, FPhysRecordData& Data)
+{
+	// Impacts grow while recording, so they follow once the bake is done rather than with their frames
+	Ar << Data.Impacts << Data.ImpactFrameStarts;
+	if (Ar.IsLoading())
+	{
+		Data.UpdateChecksum();
+		Data.Progress = 1.0f;
+		Data.Finished = true;
+	}
+}
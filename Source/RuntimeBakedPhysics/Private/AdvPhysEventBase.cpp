@@ -39,10 +39,60 @@ void AAdvPhysEventBase::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 }
 
+bool AAdvPhysEventBase::GetInfluenceSphere(FVector& OutCenter, float& OutRadius) const
+{
+	return false;
+}
+
 void AAdvPhysEventBase::DoEventPhysX(std::vector<physx::PxRigidDynamic*>& Bodies)
 {
 }
 
-void AAdvPhysEventBase::DoEventUE(TArray<FPhysObject>& Dynamics)
+void AAdvPhysEventBase::DoEventUE(TArrayView<const FPhysObject> Dynamics)
 {
 }
+
+// Editable properties of the event classes, references to other objects do not survive leaving the process
+static bool IsExportedProperty(const FProperty* Prop)
+{
+	return Prop->HasAnyPropertyFlags(CPF_Edit)
+		&& !CastField<FObjectPropertyBase>(Prop)
+		&& Prop->GetOwnerClass()->IsChildOf(AAdvPhysEventBase::StaticClass());
+}
+
+void AAdvPhysEventBase::ExportDesc(FPhysEventDesc& OutDesc) const
+{
+	OutDesc.Class = GetClass()->GetPathName();
+	OutDesc.Transform = GetActorTransform();
+	for (TFieldIterator<FProperty> It(GetClass()); It; ++It)
+	{
+		if (!IsExportedProperty(*It)) continue;
+		FString Value;
+		It->ExportTextItem(Value, It->ContainerPtrToValuePtr<void>(this), nullptr, nullptr, PPF_None);
+		OutDesc.PropertyNames.Add(It->GetName());
+		OutDesc.PropertyValues.Add(MoveTemp(Value));
+	}
+}
+
+AAdvPhysEventBase* AAdvPhysEventBase::SpawnFromDesc(UWorld* World, const FPhysEventDesc& Desc)
+{
+	UClass* Class = LoadObject<UClass>(nullptr, *Desc.Class);
+	if (!Class || !Class->IsChildOf(StaticClass()))
+	{
+		FMessageLog("AdvPhysScene").Error(FText::Format(
+			FText::FromString("Unknown event class {0}"),
+			FText::FromString(Desc.Class)
+			));
+		return nullptr;
+	}
+
+	const auto Event = World->SpawnActor<AAdvPhysEventBase>(Class, Desc.Transform);
+	if (!Event) return nullptr;
+	for (int i = 0; i < Desc.PropertyNames.Num() && i < Desc.PropertyValues.Num(); i++)
+	{
+		const auto Prop = Class->FindPropertyByName(FName(Desc.PropertyNames[i]));
+		if (!Prop || !IsExportedProperty(Prop)) continue;
+		Prop->ImportText(*Desc.PropertyValues[i], Prop->ContainerPtrToValuePtr<void>(Event), PPF_None, Event);
+	}
+	return Event;
+}
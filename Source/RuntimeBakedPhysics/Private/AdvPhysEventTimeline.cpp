@@ -0,0 +1,36 @@
+#include "AdvPhysEventTimeline.h"
+
+#include "AdvPhysEventBase.h"
+#include "AdvPhysEvent_ForceField.h"
+#include "Algo/BinarySearch.h"
+
+FPhysEventTimeline::FPhysEventTimeline(const TArray<AAdvPhysEventBase*>& EventActors, float Interval, int FrameCount)
+{
+	Entries.Reserve(EventActors.Num());
+	for (const auto& Actor : EventActors)
+	{
+		if (!Actor)
+		{
+			FMessageLog("AdvPhysScene").Error(FText::FromString("EventActors array contains invalid item"));
+			continue;
+		}
+
+		FPhysTimelineEntry Entry;
+		Entry.Time = Actor->Time;
+		Entry.Frame = Interval > 0 && FrameCount > 0 ? FPlatformMath::Min(Actor->Time / Interval, FrameCount - 1) : INDEX_NONE;
+		Entry.bIsContinuous = Actor->IsA<AAdvPhysEvent_ForceField>();
+		Entry.EventActor = Actor;
+		Entries.Add(Entry);
+	}
+	Entries.StableSort([](const FPhysTimelineEntry& A, const FPhysTimelineEntry& B) { return A.Time < B.Time; });
+}
+
+int FPhysEventTimeline::Seek(float Time) const
+{
+	return Algo::UpperBoundBy(Entries, Time, &FPhysTimelineEntry::Time);
+}
+
+int FPhysEventTimeline::SeekFrame(int Frame) const
+{
+	return Algo::LowerBoundBy(Entries, Frame, &FPhysTimelineEntry::Frame);
+}
@@ -6,6 +6,7 @@
 #include <PxRigidBodyExt.h>
 
 #include "PtouConversions.h"
+#include "PhysRecordCore.h"
 
 AAdvPhysEvent_Explosion::AAdvPhysEvent_Explosion() :
 	Impulse(5000),
@@ -13,56 +14,40 @@ AAdvPhysEvent_Explosion::AAdvPhysEvent_Explosion() :
 	FallOffMaxDistance(100)
 { }
 
+bool AAdvPhysEvent_Explosion::GetInfluenceSphere(FVector& OutCenter, float& OutRadius) const
+{
+	OutCenter = GetActorLocation();
+	OutRadius = FallOffMaxDistance;
+	return true;
+}
+
 void AAdvPhysEvent_Explosion::DoEventPhysX(std::vector<PxRigidDynamic*>& Bodies)
 {
 	Super::DoEventPhysX(Bodies);
 	const auto ExplosionPos = U2PVector(GetActorLocation());
 
-	// Fall-Offs
-	const float MaxSqr = FallOffMaxDistance * FallOffMaxDistance;
-	const float MinSqr = FallOffMinDistance * FallOffMinDistance;
-	const float MinMaxDiff = FallOffMaxDistance - FallOffMinDistance;
-			
 	for (const auto& Body : Bodies)
 	{
-		PxVec3 Dir = Body->getGlobalPose().p - ExplosionPos;
-		const float SqrDist = Dir.magnitudeSquared();
-		Dir.normalize();
-		float Multiplier = Impulse;
-		if (SqrDist > MaxSqr)
+		PxVec3 ImpulseVec;
+		if (!PhysGetExplosionImpulse(ExplosionPos, Body->getGlobalPose().p, Impulse, FallOffMinDistance, FallOffMaxDistance, ImpulseVec))
 			continue;
-		if (SqrDist > MinSqr)
-			Multiplier *= 1.0f - (FPlatformMath::Sqrt(SqrDist) - FallOffMinDistance) / MinMaxDiff;
-				
-		PxVec3 ImpulseVec = Dir * Multiplier;
 		Body->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, false);
 		PxRigidBodyExt::addForceAtPos(*Body, ImpulseVec, ExplosionPos, PxForceMode::eIMPULSE);
 	}
 }
 
-void AAdvPhysEvent_Explosion::DoEventUE(TArray<FPhysObject>& Dynamics)
+void AAdvPhysEvent_Explosion::DoEventUE(TArrayView<const FPhysObject> Dynamics)
 {
 	Super::DoEventUE(Dynamics);
 	const auto ExplosionPos = GetActorLocation();
+	const auto PExplosionPos = U2PVector(ExplosionPos);
 
-	// Fall-Offs
-	const float MaxSqr = FallOffMaxDistance * FallOffMaxDistance;
-	const float MinSqr = FallOffMinDistance * FallOffMinDistance;
-	const float MinMaxDiff = FallOffMaxDistance - FallOffMinDistance;
-			
 	for (const auto& Obj : Dynamics)
 	{
-		const auto Dir = (Obj.Comp->GetComponentLocation() - ExplosionPos).GetSafeNormal();
-		const float SqrDist = Dir.SizeSquared();
-		
-		float Multiplier = Impulse;
-		if (SqrDist > MaxSqr)
+		PxVec3 ImpulseVec;
+		if (!PhysGetExplosionImpulse(PExplosionPos, U2PVector(Obj.Comp->GetComponentLocation()), Impulse, FallOffMinDistance, FallOffMaxDistance, ImpulseVec))
 			continue;
-		if (SqrDist > MinSqr)
-			Multiplier *= 1.0f - (FPlatformMath::Sqrt(SqrDist) - FallOffMinDistance) / MinMaxDiff;
-				
-		const auto ImpulseVec = Dir * Multiplier;
-		Obj.Comp->AddImpulseAtLocation(ImpulseVec, ExplosionPos);
+		Obj.Comp->AddImpulseAtLocation(P2UVector(ImpulseVec), ExplosionPos);
 	}
 }
 
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AdvPhysEvent_ForceField.h"
+
+#include "PtouConversions.h"
+#include "PhysRecordCore.h"
+
+AAdvPhysEvent_ForceField::AAdvPhysEvent_ForceField() :
+	FieldType(Wind),
+	Duration(1),
+	Strength(1000),
+	Radius(0),
+	Direction(FVector::ForwardVector),
+	GustFrequency(1),
+	bIgnoreMass(true)
+{ }
+
+bool AAdvPhysEvent_ForceField::GetInfluenceSphere(FVector& OutCenter, float& OutRadius) const
+{
+	if (Radius <= 0) return false;
+	OutCenter = GetActorLocation();
+	OutRadius = Radius;
+	return true;
+}
+
+void AAdvPhysEvent_ForceField::ComputeForces(const float* PosX, const float* PosY, const float* PosZ, const int Count,
+	const float FieldTime, float* OutX, float* OutY, float* OutZ) const
+{
+	const FVector Center = GetActorLocation();
+	const FVector Dir = GetActorTransform().TransformVectorNoScale(Direction).GetSafeNormal();
+
+	const float Scale = PhysGetFieldScale(static_cast<PhysFieldType>(FieldType.GetValue()), Strength, GustFrequency, FieldTime);
+
+	const VectorRegister4Float CX = VectorSetFloat1(Center.X);
+	const VectorRegister4Float CY = VectorSetFloat1(Center.Y);
+	const VectorRegister4Float CZ = VectorSetFloat1(Center.Z);
+	const VectorRegister4Float DX = VectorSetFloat1(Dir.X);
+	const VectorRegister4Float DY = VectorSetFloat1(Dir.Y);
+	const VectorRegister4Float DZ = VectorSetFloat1(Dir.Z);
+	const VectorRegister4Float VScale = VectorSetFloat1(Scale);
+	const VectorRegister4Float Epsilon = VectorSetFloat1(PhysFieldEpsilon);
+	const VectorRegister4Float InvRadius = VectorSetFloat1(Radius > 0 ? 1.0f / Radius : 0.0f);
+
+	// PhysGetFieldForce four bodies at a time
+	for (int i = 0; i < Count; i += 4)
+	{
+		const VectorRegister4Float RX = VectorSubtract(VectorLoad(PosX + i), CX);
+		const VectorRegister4Float RY = VectorSubtract(VectorLoad(PosY + i), CY);
+		const VectorRegister4Float RZ = VectorSubtract(VectorLoad(PosZ + i), CZ);
+
+		// Linear fall-off towards Radius, no fall-off for scene-wide fields
+		const VectorRegister4Float SqrDist = VectorMultiplyAdd(RX, RX, VectorMultiplyAdd(RY, RY, VectorMultiply(RZ, RZ)));
+		const VectorRegister4Float Dist = VectorMultiply(SqrDist, VectorReciprocalSqrt(VectorAdd(SqrDist, Epsilon)));
+		const VectorRegister4Float FallOff = VectorMax(VectorZeroFloat(), VectorSubtract(VectorOneFloat(), VectorMultiply(Dist, InvRadius)));
+		const VectorRegister4Float Magnitude = VectorMultiply(VScale, FallOff);
+
+		VectorRegister4Float FX, FY, FZ;
+		switch (FieldType)
+		{
+		case RadialPull:
+		{
+			const VectorRegister4Float InvDist = VectorReciprocalSqrt(VectorAdd(SqrDist, Epsilon));
+			const VectorRegister4Float M = VectorNegate(VectorMultiply(Magnitude, InvDist));
+			FX = VectorMultiply(RX, M);
+			FY = VectorMultiply(RY, M);
+			FZ = VectorMultiply(RZ, M);
+			break;
+		}
+		case Vortex:
+		{
+			// Tangent around the axis, Dir x R, normalized so the same strength applies at any distance from the axis
+			const VectorRegister4Float TX = VectorSubtract(VectorMultiply(DY, RZ), VectorMultiply(DZ, RY));
+			const VectorRegister4Float TY = VectorSubtract(VectorMultiply(DZ, RX), VectorMultiply(DX, RZ));
+			const VectorRegister4Float TZ = VectorSubtract(VectorMultiply(DX, RY), VectorMultiply(DY, RX));
+			const VectorRegister4Float SqrLen = VectorMultiplyAdd(TX, TX, VectorMultiplyAdd(TY, TY, VectorMultiply(TZ, TZ)));
+			const VectorRegister4Float M = VectorMultiply(Magnitude, VectorReciprocalSqrt(VectorAdd(SqrLen, Epsilon)));
+			FX = VectorMultiply(TX, M);
+			FY = VectorMultiply(TY, M);
+			FZ = VectorMultiply(TZ, M);
+			break;
+		}
+		case Wind:
+		case DirectionalGust:
+		default:
+		{
+			FX = VectorMultiply(DX, Magnitude);
+			FY = VectorMultiply(DY, Magnitude);
+			FZ = VectorMultiply(DZ, Magnitude);
+			break;
+		}
+		}
+
+		VectorStore(FX, OutX + i);
+		VectorStore(FY, OutY + i);
+		VectorStore(FZ, OutZ + i);
+	}
+}
@@ -0,0 +1,228 @@
+#include "AdvPhysFidelityCommandlet.h"
+
+#include "AdvPhysScene.h"
+#include "AdvPhysSceneFile.h"
+#include "AdvPhysSyntheticScene.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PhysSimulator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAdvPhysFidelity, Log, All);
+
+struct FFidelitySettings
+{
+	float Duration = 5.0f;
+	float ReferenceInterval = 1.0f / 240.0f;
+	TArray<float> Intervals;
+	TArray<int> Substeps;
+};
+
+struct FFidelityResult
+{
+	FString Scene;
+	float Interval;
+	int Substeps;
+	bool bInterpolation;
+	uint64 BakeBytes;
+	float MaxPositionError = 0.0f;
+	float MeanPositionError = 0.0f;
+	// Degrees
+	float MaxRotationError = 0.0f;
+	float MeanRotationError = 0.0f;
+	int WorstFrame = INDEX_NONE;
+	FName WorstObject;
+};
+
+UAdvPhysFidelityCommandlet::UAdvPhysFidelityCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+// Deterministic, so every configuration starts from the same simulation and differs only by rate and substeps
+static FPhysRecordDataPtr RecordBake(const FPhysSceneDesc& Desc, float Interval, int Substeps, float Duration)
+{
+	auto Data = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	Data->ObjectIds = Desc.ObjectIds;
+
+	PhysSimulator Simulator;
+	Simulator.SetDeterministic(true);
+	Simulator.Initialize();
+	Simulator.ImportScene(Desc);
+	Simulator.Controller = nullptr;
+	Simulator.SetSubsteps(Substeps);
+	Simulator.StartRecord(Data.Get(), Interval, FMath::CeilToInt(Duration / Interval) + 1, Desc.GravityZ);
+	while (Simulator.IsRecording())
+	{
+		FPlatformProcess::Sleep(0.005f);
+	}
+	Simulator.Cleanup();
+	return Data;
+}
+
+// Plays the bake at every frame time of the reference and compares the poses the scene's objects end up in
+static void MeasurePlayback(AAdvPhysScene* Scene, const FPhysRecordData& Reference, FFidelityResult& Result)
+{
+	const int NumOfObjects = Reference.ObjectCount;
+	double SumPosition = 0.0;
+	double SumRotation = 0.0;
+	for (int Frame = 0; Frame < Reference.FrameCount; Frame++)
+	{
+		Scene->PlayFrame(Frame * Reference.FrameInterval);
+		for (int ObjIndex = 0; ObjIndex < NumOfObjects; ObjIndex++)
+		{
+			const auto& Truth = Reference.ObjLocRot[Frame * NumOfObjects + ObjIndex];
+			const auto& Comp = Scene->DynamicObjEntries[ObjIndex].Comp;
+			const float PositionError = FVector::Dist(Comp->GetComponentLocation(), Truth.Location);
+			const float RotationError = FMath::RadiansToDegrees(Comp->GetComponentQuat().AngularDistance(Truth.Rotation.Quaternion()));
+			SumPosition += PositionError;
+			SumRotation += RotationError;
+			if (PositionError > Result.MaxPositionError)
+			{
+				Result.MaxPositionError = PositionError;
+				Result.WorstFrame = Frame;
+				Result.WorstObject = Reference.ObjectIds.IsValidIndex(ObjIndex) ? Reference.ObjectIds[ObjIndex] : NAME_None;
+			}
+			Result.MaxRotationError = FMath::Max(Result.MaxRotationError, RotationError);
+		}
+	}
+	const int NumOfSamples = FMath::Max(1, Reference.FrameCount * NumOfObjects);
+	Result.MeanPositionError = SumPosition / NumOfSamples;
+	Result.MeanRotationError = SumRotation / NumOfSamples;
+}
+
+static void MeasureScene(UWorld* World, const FString& Name, const FPhysSceneDesc& Desc, const FFidelitySettings& Settings,
+	TArray<FFidelityResult>& OutResults)
+{
+	UE_LOG(LogAdvPhysFidelity, Display, TEXT("%s: recording reference at %fs"), *Name, Settings.ReferenceInterval);
+	const FPhysRecordDataPtr Reference = RecordBake(Desc, Settings.ReferenceInterval, 1, Settings.Duration);
+
+	// Objects are only moved by playback, they need no meshes
+	AAdvPhysScene* Scene = World->SpawnActor<AAdvPhysScene>();
+	for (int i = 0; i < Reference->ObjectCount; i++)
+	{
+		UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(Scene);
+		Comp->SetupAttachment(Scene->GetRootComponent());
+		Comp->RegisterComponent();
+		Scene->AddDynamicObj(Comp);
+	}
+
+	for (const float Interval : Settings.Intervals)
+	{
+		for (const int Substeps : Settings.Substeps)
+		{
+			Scene->RecordData = RecordBake(Desc, Interval, Substeps, Settings.Duration);
+			for (const bool bInterpolation : { false, true })
+			{
+				FFidelityResult Result;
+				Result.Scene = Name;
+				Result.Interval = Interval;
+				Result.Substeps = Substeps;
+				Result.bInterpolation = bInterpolation;
+				Result.BakeBytes = Scene->RecordData->GetAllocatedSize();
+				Scene->bEnableInterpolation = bInterpolation;
+				MeasurePlayback(Scene, *Reference, Result);
+				UE_LOG(LogAdvPhysFidelity, Display,
+					TEXT("%s: %fs x%d %-13s %10llu bytes  position max %8.3f mean %8.3f  rotation max %7.2f mean %7.2f"),
+					*Name, Interval, Substeps, bInterpolation ? TEXT("interpolated") : TEXT("snapped"), Result.BakeBytes,
+					Result.MaxPositionError, Result.MeanPositionError, Result.MaxRotationError, Result.MeanRotationError);
+				OutResults.Add(Result);
+			}
+		}
+	}
+	Scene->Destroy();
+}
+
+template <typename ValueType>
+static void ParseList(const FString& Params, const TCHAR* Name, const TCHAR* Default, TArray<ValueType>& OutValues)
+{
+	FString List = Default;
+	FParse::Value(*Params, Name, List, false);
+	TArray<FString> Entries;
+	List.ParseIntoArray(Entries, TEXT(","));
+	for (const auto& Entry : Entries)
+	{
+		ValueType Value;
+		LexFromString(Value, *Entry);
+		if (Value > 0) OutValues.Add(Value);
+	}
+}
+
+int32 UAdvPhysFidelityCommandlet::Main(const FString& Params)
+{
+	FFidelitySettings Settings;
+	FParse::Value(*Params, TEXT("duration="), Settings.Duration);
+	FParse::Value(*Params, TEXT("reference="), Settings.ReferenceInterval);
+	ParseList(Params, TEXT("intervals="), TEXT("0.0166,0.0333,0.0666"), Settings.Intervals);
+	ParseList(Params, TEXT("substeps="), TEXT("1"), Settings.Substeps);
+	if (Settings.Duration <= 0.0f || Settings.ReferenceInterval <= 0.0f || Settings.Intervals.Num() == 0 || Settings.Substeps.Num() == 0)
+	{
+		UE_LOG(LogAdvPhysFidelity, Error, TEXT("-duration, -reference, -intervals and -substeps must be positive"));
+		return 1;
+	}
+
+	int32 Threads = 0;
+	if (FParse::Value(*Params, TEXT("threads="), Threads))
+	{
+		PhysSimulator::DispatcherThreads = FMath::Max(1, Threads);
+	}
+
+	// Scene files exported with AAdvPhysScene::ExportSceneFile, or synthetic piles
+	TArray<TPair<FString, FPhysSceneDesc>> Scenes;
+	FString ScenePath;
+	if (FParse::Value(*Params, TEXT("scene="), ScenePath))
+	{
+		auto& Scene = Scenes.AddDefaulted_GetRef();
+		Scene.Key = FPaths::GetBaseFilename(ScenePath);
+		if (!AdvPhysSceneFile::Load(ScenePath, Scene.Value))
+		{
+			UE_LOG(LogAdvPhysFidelity, Error, TEXT("Could not load scene file %s"), *ScenePath);
+			return 1;
+		}
+	}
+	else
+	{
+		FString Shape = TEXT("box");
+		FParse::Value(*Params, TEXT("shape="), Shape);
+		Shape.ToLowerInline();
+		TArray<int> Counts;
+		ParseList(Params, TEXT("counts="), TEXT("200"), Counts);
+		for (const int NumOfBodies : Counts)
+		{
+			auto& Scene = Scenes.AddDefaulted_GetRef();
+			Scene.Key = FString::Printf(TEXT("%s-%d"), *Shape, NumOfBodies);
+			AdvPhysSyntheticScene::MakePiles(NumOfBodies, Shape, Scene.Value);
+			Scene.Value.GravityZ = -980.0f;
+		}
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Inactive, false);
+	TArray<FFidelityResult> Results;
+	for (const auto& Scene : Scenes)
+	{
+		MeasureScene(World, Scene.Key, Scene.Value, Settings, Results);
+	}
+	World->DestroyWorld(false);
+
+	// Memory against error, cheapest bakes first
+	Results.StableSort([](const FFidelityResult& A, const FFidelityResult& B)
+	{
+		return A.Scene == B.Scene ? A.BakeBytes < B.BakeBytes : A.Scene < B.Scene;
+	});
+	FString Csv = TEXT("scene,interval,substeps,interpolation,bake_bytes,max_position_error,mean_position_error,max_rotation_error,mean_rotation_error,worst_frame,worst_object\n");
+	for (const auto& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%s,%f,%d,%d,%llu,%f,%f,%f,%f,%d,%s\n"),
+			*Result.Scene, Result.Interval, Result.Substeps, Result.bInterpolation ? 1 : 0, Result.BakeBytes,
+			Result.MaxPositionError, Result.MeanPositionError, Result.MaxRotationError, Result.MeanRotationError,
+			Result.WorstFrame, *Result.WorstObject.ToString());
+	}
+	FString Path = FPaths::ProjectSavedDir() / TEXT("AdvPhysBenchmarks") / (TEXT("Fidelity-") + FDateTime::Now().ToString() + TEXT(".csv"));
+	FParse::Value(*Params, TEXT("out="), Path);
+	FFileHelper::SaveStringToFile(Csv, *Path);
+	UE_LOG(LogAdvPhysFidelity, Display, TEXT("Wrote %s"), *Path);
+	return 0;
+}
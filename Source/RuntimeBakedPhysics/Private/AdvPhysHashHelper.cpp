@@ -1,67 +1,58 @@
 ﻿#include "AdvPhysHashHelper.h"
 
 void AdvPhysHashHelper::GetHash(const physx::PxBounds3 Bounds,
-	const FVector WorldCenter, const float CellSize, uint32& Start, uint32& End)
+	const FVector WorldCenter, const float CellSize, uint64& Start, uint64& End)
 {
 	Start = GetHash(Bounds.minimum, WorldCenter, CellSize);
 	End = GetHash(Bounds.maximum, WorldCenter, CellSize);
 }
 
-void AdvPhysHashHelper::GetHash(FBox Bounds, FVector WorldCenter, float CellSize, uint32& Start, uint32& End)
+void AdvPhysHashHelper::GetHash(FBox Bounds, FVector WorldCenter, float CellSize, uint64& Start, uint64& End)
 {
 	Start = GetHash(Bounds.Min, WorldCenter, CellSize);
 	End = GetHash(Bounds.Max, WorldCenter, CellSize);
 }
 
-uint32 AdvPhysHashHelper::GetHash(const physx::PxVec3 Point, const FVector WorldCenter, const float CellSize)
+uint64 AdvPhysHashHelper::GetHash(const physx::PxVec3 Point, const FVector WorldCenter, const float CellSize)
 {
-	const double OffsetMetersFromCenter = CellSize * WORLD_CELL_LENGTH / 2.0f;
-
-	const double CellWorldStartX = WorldCenter.X - OffsetMetersFromCenter;
-	const double CellWorldStartY = WorldCenter.Y - OffsetMetersFromCenter;
-	const double CellWorldStartZ = WorldCenter.Z - OffsetMetersFromCenter;
-
-	const unsigned StartCellX = static_cast<unsigned>((Point.x - CellWorldStartX) / CellSize);
-	const unsigned StartCellY = static_cast<unsigned>((Point.y - CellWorldStartY) / CellSize);
-	const unsigned StartCellZ = static_cast<unsigned>((Point.z - CellWorldStartZ) / CellSize);
-
-	return JoinToHash(StartCellX, StartCellY, StartCellZ);
+	return GetHash(FVector(Point.x, Point.y, Point.z), WorldCenter, CellSize);
 }
 
-uint32 AdvPhysHashHelper::GetHash(FVector Point, FVector WorldCenter, float CellSize)
+uint64 AdvPhysHashHelper::GetHash(FVector Point, FVector WorldCenter, float CellSize)
 {
-	const double OffsetMetersFromCenter = CellSize * WORLD_CELL_LENGTH / 2.0f;
-
-	const double CellWorldStartX = WorldCenter.X - OffsetMetersFromCenter;
-	const double CellWorldStartY = WorldCenter.Y - OffsetMetersFromCenter;
-	const double CellWorldStartZ = WorldCenter.Z - OffsetMetersFromCenter;
+	const double Center[3] = { WorldCenter.X, WorldCenter.Y, WorldCenter.Z };
+	return PhysGetHash(Point.X, Point.Y, Point.Z, Center, CellSize);
+}
 
-	const unsigned StartCellX = static_cast<unsigned>((Point.X - CellWorldStartX) / CellSize);
-	const unsigned StartCellY = static_cast<unsigned>((Point.Y - CellWorldStartY) / CellSize);
-	const unsigned StartCellZ = static_cast<unsigned>((Point.Z - CellWorldStartZ) / CellSize);
+void AdvPhysHashHelper::SplitFromHash(const uint64 Hash, unsigned& X, unsigned& Y, unsigned& Z)
+{
+	X = PhysCompactBits(Hash >> 2);
+	Y = PhysCompactBits(Hash >> 1);
+	Z = PhysCompactBits(Hash);
+}
 
-	return JoinToHash(StartCellX, StartCellY, StartCellZ);
+uint64 AdvPhysHashHelper::JoinToHash(const unsigned X, const unsigned Y, const unsigned Z)
+{
+	return PhysJoinToHash(X, Y, Z);
 }
 
-void AdvPhysHashHelper::SplitFromHash(const uint32 Hash, unsigned& X, unsigned& Y, unsigned& Z)
+FVector AdvPhysHashHelper::GetCellWorldStart(const FVector WorldCenter, const float CellSize)
 {
-	X = Hash / (WORLD_CELL_LENGTH * WORLD_CELL_LENGTH);
-	Y = (Hash - X * WORLD_CELL_LENGTH * WORLD_CELL_LENGTH) / WORLD_CELL_LENGTH;
-	Z = (Hash - X * WORLD_CELL_LENGTH * WORLD_CELL_LENGTH - Y * WORLD_CELL_LENGTH);
+	return WorldCenter - PhysGetCellOffset(CellSize) * FVector::OneVector;
 }
 
-int32 AdvPhysHashHelper::JoinToHash(const unsigned X, const unsigned Y, const unsigned Z)
+uint64 AdvPhysHashHelper::ToCoarseHash(const uint64 Hash, unsigned CoarseShift)
 {
-	return X * WORLD_CELL_LENGTH * WORLD_CELL_LENGTH + Y * WORLD_CELL_LENGTH + Z;
+	unsigned X, Y, Z;
+	SplitFromHash(Hash, X, Y, Z);
+	CoarseShift = FMath::Min(CoarseShift, static_cast<unsigned>(WORLD_CELL_BITS));
+	return JoinToHash(X >> CoarseShift, Y >> CoarseShift, Z >> CoarseShift) | COARSE_HASH_FLAG;
 }
 
-void AdvPhysHashHelper::CubicSweepHash(uint32 Start, uint32 End, std::function<void(uint32)> Action)
+unsigned AdvPhysHashHelper::GetMaxCellSpan(const uint64 Start, const uint64 End)
 {
 	unsigned MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
 	SplitFromHash(Start, MinX, MinY, MinZ);
 	SplitFromHash(End, MaxX, MaxY, MaxZ);
-	for (unsigned X = MinX; X <= MaxX; X++)
-		for (unsigned Y = MinY; Y <= MaxY; Y++)
-			for (unsigned Z = MinZ; Z <= MaxZ; Z++)
-				Action(JoinToHash(X, Y, Z));
+	return FMath::Max3(MaxX - MinX, MaxY - MinY, MaxZ - MinZ) + 1;
 }
@@ -0,0 +1,285 @@
+#include "AdvPhysPlaybackBenchmarkCommandlet.h"
+
+#include "AdvPhysHashHelper.h"
+#include "AdvPhysSODKernel.h"
+#include "AdvPhysScene.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAdvPhysPlaybackBenchmark, Log, All);
+
+#define WARMUP_ITERATIONS 5
+#define OBJECT_SIZE 50.0f
+
+struct FPlaybackBenchmarkSettings
+{
+	FString Motion = TEXT("fall");
+	int FrameCount = 300;
+	int Iterations = 200;
+	float HashCellSize = 100.0f;
+	int32 Seed = 1;
+};
+
+struct FPlaybackBenchmarkResult
+{
+	FString Name;
+	int NumOfObjects;
+	int NumOfActivators;
+	// Microseconds per iteration
+	double Min;
+	double Median;
+	double Mean;
+	double P95;
+	double StdDev;
+};
+
+UAdvPhysPlaybackBenchmarkCommandlet::UAdvPhysPlaybackBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+// Runs Body Iterations times after a warm-up, Setup before each run is not timed
+template <typename SetupType, typename BodyType>
+static FPlaybackBenchmarkResult Measure(const FString& Name, int Iterations, SetupType&& Setup, BodyType&& Body)
+{
+	TArray<double> Samples;
+	Samples.Reserve(Iterations);
+	for (int i = -WARMUP_ITERATIONS; i < Iterations; i++)
+	{
+		Setup(i);
+		const double Start = FPlatformTime::Seconds();
+		Body(i);
+		const double Elapsed = (FPlatformTime::Seconds() - Start) * 1.e6;
+		if (i >= 0) Samples.Add(Elapsed);
+	}
+	Samples.Sort();
+
+	FPlaybackBenchmarkResult Result;
+	Result.Name = Name;
+	Result.Min = Samples[0];
+	Result.Median = Samples[Samples.Num() / 2];
+	Result.P95 = Samples[FMath::Min(Samples.Num() - 1, FMath::CeilToInt(Samples.Num() * 0.95f) - 1)];
+	double Sum = 0.0;
+	for (const double Sample : Samples) Sum += Sample;
+	Result.Mean = Sum / Samples.Num();
+	double Variance = 0.0;
+	for (const double Sample : Samples) Variance += FMath::Square(Sample - Result.Mean);
+	Result.StdDev = FMath::Sqrt(Variance / Samples.Num());
+	return Result;
+}
+
+static FVector GetSyntheticLocation(const FString& Motion, int ObjIndex, int NumOfObjects, float Time)
+{
+	const int Side = FMath::CeilToInt(FMath::Pow(static_cast<float>(NumOfObjects), 1.0f / 3.0f));
+	const FVector Start(
+		(ObjIndex % Side) * OBJECT_SIZE * 2.0f,
+		(ObjIndex / Side % Side) * OBJECT_SIZE * 2.0f,
+		(ObjIndex / (Side * Side)) * OBJECT_SIZE * 2.0f);
+
+	if (Motion == TEXT("rest")) return Start;
+	if (Motion == TEXT("scatter"))
+	{
+		const FVector Center = FVector(Side * OBJECT_SIZE);
+		return Start + (Start - Center).GetSafeNormal() * 1000.0f * Time + FVector(0.0f, 0.0f, -490.0f * Time * Time);
+	}
+	// Falling onto a floor at -1000 and resting there
+	return FVector(Start.X, Start.Y, FMath::Max(-1000.0f, Start.Z - 490.0f * Time * Time));
+}
+
+static FPhysRecordDataPtr MakeSyntheticBake(const AAdvPhysScene* Scene, const FPlaybackBenchmarkSettings& Settings)
+{
+	const int NumOfObjects = Scene->DynamicObjEntries.Num();
+	auto Data = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	Data->Finished = true;
+	Data->Progress = 1.0f;
+	Data->FrameCount = Settings.FrameCount;
+	Data->FrameInterval = 1.0f / 60.0f;
+	Data->ObjectCount = NumOfObjects;
+	Data->bEnableSOD = true;
+	Data->HashWorldCenter = FVector::ZeroVector;
+	Data->HashCellSize = Settings.HashCellSize;
+	for (const auto& Obj : Scene->DynamicObjEntries)
+	{
+		Data->ObjectIds.Add(Obj.Id);
+	}
+
+	const int Stride = AdvPhysSODKernel::GetStride(NumOfObjects);
+	Data->SODSoAStride = Stride;
+	Data->ObjLocRot.SetNumUninitialized(Settings.FrameCount * NumOfObjects);
+	Data->ObjSOD.SetNumUninitialized(Settings.FrameCount * NumOfObjects);
+	Data->ObjSODSoA.SetNumZeroed(Settings.FrameCount * SOD_SOA_PLANES * Stride);
+	for (int Frame = 0; Frame < Settings.FrameCount; Frame++)
+	{
+		float* FrameSoA = &Data->ObjSODSoA[Frame * SOD_SOA_PLANES * Stride];
+		AdvPhysSODKernel::ResetPadding(FrameSoA, NumOfObjects, Stride);
+		for (int i = 0; i < NumOfObjects; i++)
+		{
+			const float Time = Frame * Data->FrameInterval;
+			auto& LocRot = Data->ObjLocRot[Frame * NumOfObjects + i];
+			LocRot.Location = GetSyntheticLocation(Settings.Motion, i, NumOfObjects, Time);
+			LocRot.Rotation = Settings.Motion == TEXT("rest") ? FRotator::ZeroRotator : FRotator(Time * 90.0f, Time * 45.0f, 0.0f);
+
+			auto& SOD = Data->ObjSOD[Frame * NumOfObjects + i];
+			SOD.Bounds = FBox::BuildAABB(LocRot.Location, FVector(OBJECT_SIZE / 2.0f));
+			AdvPhysHashHelper::GetHash(SOD.Bounds, Data->HashWorldCenter, Data->HashCellSize, SOD.StartHash, SOD.EndHash);
+			AdvPhysSODKernel::WriteBounds(FrameSoA, Stride, i, SOD.Bounds.Min, SOD.Bounds.Max);
+		}
+	}
+	return Data;
+}
+
+static void BenchmarkScene(UWorld* World, int NumOfObjects, const TArray<int>& ActivatorCounts, const FPlaybackBenchmarkSettings& Settings,
+	TArray<FPlaybackBenchmarkResult>& OutResults)
+{
+	AAdvPhysScene* Scene = World->SpawnActor<AAdvPhysScene>();
+	for (int i = 0; i < NumOfObjects; i++)
+	{
+		UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(Scene);
+		Comp->SetupAttachment(Scene->GetRootComponent());
+		Comp->RegisterComponent();
+		Scene->AddDynamicObj(Comp);
+	}
+	Scene->RecordData = MakeSyntheticBake(Scene, Settings);
+	Scene->Status.SODActivationState.Init(false, NumOfObjects);
+	Scene->Status.SODWorkspace = MakeShared<FSODWorkspace, ESPMode::ThreadSafe>();
+
+	FRandomStream Random(Settings.Seed);
+	const float Duration = Settings.FrameCount * Scene->RecordData->FrameInterval;
+	const auto Add = [&](FPlaybackBenchmarkResult Result, int NumOfActivators)
+	{
+		Result.NumOfObjects = NumOfObjects;
+		Result.NumOfActivators = NumOfActivators;
+		UE_LOG(LogAdvPhysPlaybackBenchmark, Display, TEXT("%-24s %6d objects %3d activators: median %10.2fus  p95 %10.2fus  stddev %8.2fus"),
+			*Result.Name, NumOfObjects, NumOfActivators, Result.Median, Result.P95, Result.StdDev);
+		OutResults.Add(Result);
+	};
+	const auto NoSetup = [](int) {};
+
+	Scene->bEnableInterpolation = true;
+	Add(Measure(TEXT("PlayFrame"), Settings.Iterations, NoSetup,
+		[&](int) { Scene->PlayFrame(Random.FRandRange(0.0f, Duration)); }), 0);
+	Scene->bEnableInterpolation = false;
+	Add(Measure(TEXT("PlayFrameNoInterpolation"), Settings.Iterations, NoSetup,
+		[&](int) { Scene->PlayFrame(Random.FRandRange(0.0f, Duration)); }), 0);
+
+	auto& Workspace = *Scene->Status.SODWorkspace;
+	int FrameIndex = 0;
+	for (const int NumOfActivators : ActivatorCounts)
+	{
+		// Activators around random objects of a random frame, fresh activation state for every run
+		const auto Setup = [&](int)
+		{
+			FrameIndex = Random.RandHelper(Settings.FrameCount);
+			Workspace.ActivatorBounds.Reset();
+			for (int i = 0; i < NumOfActivators; i++)
+			{
+				const auto& Bounds = Scene->RecordData->ObjSOD[FrameIndex * NumOfObjects + Random.RandHelper(NumOfObjects)].Bounds;
+				Workspace.ActivatorBounds.Add(Bounds.ExpandBy(OBJECT_SIZE));
+			}
+			Workspace.ActivationState.Init(false, NumOfObjects);
+			Workspace.Activated.Reset();
+		};
+
+		Scene->bUseNaiveSODCheck = true;
+		Add(Measure(TEXT("DetectSODNaive"), Settings.Iterations, Setup,
+			[&](int) { Scene->DetectSOD(FrameIndex, Workspace); }), NumOfActivators);
+		Scene->bUseNaiveSODCheck = false;
+		Add(Measure(TEXT("DetectSODHashed"), Settings.Iterations, Setup,
+			[&](int) { Scene->DetectSOD(FrameIndex, Workspace); }), NumOfActivators);
+		Add(Measure(TEXT("RebuildSODMap"), Settings.Iterations, Setup,
+			[&](int) { Scene->RebuildSODMap(FrameIndex, Workspace); }), NumOfActivators);
+		Add(Measure(TEXT("CheckFromSODMap"), Settings.Iterations,
+			[&](int i) { Setup(i); Scene->RebuildSODMap(FrameIndex, Workspace); },
+			[&](int) { Scene->CheckFromSODMap(FrameIndex, Workspace); }), NumOfActivators);
+	}
+
+	// Hash helpers over the bounds of a whole frame
+	const FPhysObjSODData* FrameSOD = nullptr;
+	const auto PickFrame = [&](int) { FrameSOD = &Scene->RecordData->ObjSOD[Random.RandHelper(Settings.FrameCount) * NumOfObjects]; };
+	uint64 Sink = 0;
+	Add(Measure(TEXT("GetHash"), Settings.Iterations, PickFrame, [&](int)
+	{
+		for (int i = 0; i < NumOfObjects; i++)
+		{
+			uint64 Start, End;
+			AdvPhysHashHelper::GetHash(FrameSOD[i].Bounds, Scene->RecordData->HashWorldCenter, Scene->RecordData->HashCellSize, Start, End);
+			Sink += Start ^ End;
+		}
+	}), 0);
+	Add(Measure(TEXT("CubicSweepHash"), Settings.Iterations, PickFrame, [&](int)
+	{
+		for (int i = 0; i < NumOfObjects; i++)
+		{
+			AdvPhysHashHelper::CubicSweepHash(FrameSOD[i].StartHash, FrameSOD[i].EndHash, [&Sink](uint64 Hash) { Sink += Hash; });
+		}
+	}), 0);
+	Add(Measure(TEXT("ToCoarseHash"), Settings.Iterations, PickFrame, [&](int)
+	{
+		for (int i = 0; i < NumOfObjects; i++)
+		{
+			Sink += AdvPhysHashHelper::ToCoarseHash(FrameSOD[i].StartHash, Scene->GetSODCoarseShift())
+				^ AdvPhysHashHelper::ToCoarseHash(FrameSOD[i].EndHash, Scene->GetSODCoarseShift());
+		}
+	}), 0);
+	// Keeps the loops above from being optimized away
+	UE_LOG(LogAdvPhysPlaybackBenchmark, Verbose, TEXT("Hash checksum %llu"), Sink);
+
+	Scene->Destroy();
+}
+
+static void ParseCounts(const FString& Params, const TCHAR* Name, const TCHAR* Default, TArray<int>& OutCounts)
+{
+	FString Counts = Default;
+	FParse::Value(*Params, Name, Counts, false);
+	TArray<FString> Entries;
+	Counts.ParseIntoArray(Entries, TEXT(","));
+	for (const auto& Entry : Entries)
+	{
+		const int Count = FCString::Atoi(*Entry);
+		if (Count > 0) OutCounts.Add(Count);
+	}
+}
+
+int32 UAdvPhysPlaybackBenchmarkCommandlet::Main(const FString& Params)
+{
+	FPlaybackBenchmarkSettings Settings;
+	FParse::Value(*Params, TEXT("motion="), Settings.Motion);
+	FParse::Value(*Params, TEXT("frames="), Settings.FrameCount);
+	FParse::Value(*Params, TEXT("iterations="), Settings.Iterations);
+	FParse::Value(*Params, TEXT("cellsize="), Settings.HashCellSize);
+	FParse::Value(*Params, TEXT("seed="), Settings.Seed);
+	Settings.Motion.ToLowerInline();
+	if (Settings.FrameCount <= 0 || Settings.Iterations <= 0 || Settings.HashCellSize <= 0.0f)
+	{
+		UE_LOG(LogAdvPhysPlaybackBenchmark, Error, TEXT("-frames, -iterations and -cellsize must be positive"));
+		return 1;
+	}
+
+	TArray<int> ObjectCounts, ActivatorCounts;
+	ParseCounts(Params, TEXT("objects="), TEXT("1000,10000"), ObjectCounts);
+	ParseCounts(Params, TEXT("activators="), TEXT("1,16"), ActivatorCounts);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Inactive, false);
+	TArray<FPlaybackBenchmarkResult> Results;
+	for (const int NumOfObjects : ObjectCounts)
+	{
+		BenchmarkScene(World, NumOfObjects, ActivatorCounts, Settings, Results);
+	}
+	World->DestroyWorld(false);
+
+	FString Csv = TEXT("name,motion,objects,activators,min_us,median_us,mean_us,p95_us,stddev_us\n");
+	for (const auto& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%s,%s,%d,%d,%f,%f,%f,%f,%f\n"), *Result.Name, *Settings.Motion, Result.NumOfObjects, Result.NumOfActivators,
+			Result.Min, Result.Median, Result.Mean, Result.P95, Result.StdDev);
+	}
+	FString Path = FPaths::ProjectSavedDir() / TEXT("AdvPhysBenchmarks") / (TEXT("PlaybackBenchmark-") + FDateTime::Now().ToString() + TEXT(".csv"));
+	FParse::Value(*Params, TEXT("out="), Path);
+	FFileHelper::SaveStringToFile(Csv, *Path);
+	UE_LOG(LogAdvPhysPlaybackBenchmark, Display, TEXT("Wrote %s"), *Path);
+	return 0;
+}
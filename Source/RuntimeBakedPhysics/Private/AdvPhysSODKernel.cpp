@@ -0,0 +1,75 @@
+#include "AdvPhysSODKernel.h"
+
+int AdvPhysSODKernel::GetStride(const int NumOfObjects)
+{
+	return Align(NumOfObjects, SOD_KERNEL_WIDTH);
+}
+
+void AdvPhysSODKernel::ResetPadding(float* FrameSoA, const int NumOfObjects, const int Stride)
+{
+	for (int i = NumOfObjects; i < Stride; i++)
+	{
+		FrameSoA[0 * Stride + i] = MAX_flt;
+		FrameSoA[1 * Stride + i] = MAX_flt;
+		FrameSoA[2 * Stride + i] = MAX_flt;
+		FrameSoA[3 * Stride + i] = -MAX_flt;
+		FrameSoA[4 * Stride + i] = -MAX_flt;
+		FrameSoA[5 * Stride + i] = -MAX_flt;
+	}
+}
+
+void AdvPhysSODKernel::WriteBounds(float* FrameSoA, const int Stride, const int ObjIndex, const FVector& Min, const FVector& Max)
+{
+	FrameSoA[0 * Stride + ObjIndex] = Min.X;
+	FrameSoA[1 * Stride + ObjIndex] = Min.Y;
+	FrameSoA[2 * Stride + ObjIndex] = Min.Z;
+	FrameSoA[3 * Stride + ObjIndex] = Max.X;
+	FrameSoA[4 * Stride + ObjIndex] = Max.Y;
+	FrameSoA[5 * Stride + ObjIndex] = Max.Z;
+}
+
+void AdvPhysSODKernel::OverlapActivators(const float* FrameSoA, const int Stride, const TArray<FBox>& Activators, TArray<uint32>& OutMask)
+{
+	OutMask.Reset();
+	OutMask.AddZeroed(FMath::DivideAndRoundUp(Stride, 32));
+	if (Activators.Num() == 0) return;
+
+	// Splat activator boxes once, they are reused for every block of objects
+	TArray<VectorRegister4Float, TInlineAllocator<16 * SOD_SOA_PLANES>> Splats;
+	Splats.Reserve(Activators.Num() * SOD_SOA_PLANES);
+	for (const auto& Box : Activators)
+	{
+		Splats.Add(VectorSetFloat1(Box.Min.X));
+		Splats.Add(VectorSetFloat1(Box.Min.Y));
+		Splats.Add(VectorSetFloat1(Box.Min.Z));
+		Splats.Add(VectorSetFloat1(Box.Max.X));
+		Splats.Add(VectorSetFloat1(Box.Max.Y));
+		Splats.Add(VectorSetFloat1(Box.Max.Z));
+	}
+
+	for (int Base = 0; Base < Stride; Base += SOD_KERNEL_WIDTH)
+	{
+		const VectorRegister4Float MinX = VectorLoad(FrameSoA + 0 * Stride + Base);
+		const VectorRegister4Float MinY = VectorLoad(FrameSoA + 1 * Stride + Base);
+		const VectorRegister4Float MinZ = VectorLoad(FrameSoA + 2 * Stride + Base);
+		const VectorRegister4Float MaxX = VectorLoad(FrameSoA + 3 * Stride + Base);
+		const VectorRegister4Float MaxY = VectorLoad(FrameSoA + 4 * Stride + Base);
+		const VectorRegister4Float MaxZ = VectorLoad(FrameSoA + 5 * Stride + Base);
+
+		VectorRegister4Float Hit = VectorZeroFloat();
+		for (int i = 0; i < Splats.Num(); i += SOD_SOA_PLANES)
+		{
+			// Same test as FBox::Intersect, Min <= Other.Max && Other.Min <= Max on every axis
+			VectorRegister4Float Overlap = VectorBitwiseAnd(VectorCompareLE(MinX, Splats[i + 3]), VectorCompareLE(Splats[i + 0], MaxX));
+			Overlap = VectorBitwiseAnd(Overlap, VectorCompareLE(MinY, Splats[i + 4]));
+			Overlap = VectorBitwiseAnd(Overlap, VectorCompareLE(Splats[i + 1], MaxY));
+			Overlap = VectorBitwiseAnd(Overlap, VectorCompareLE(MinZ, Splats[i + 5]));
+			Overlap = VectorBitwiseAnd(Overlap, VectorCompareLE(Splats[i + 2], MaxZ));
+			Hit = VectorBitwiseOr(Hit, Overlap);
+		}
+
+		const uint32 Bits = VectorMaskBits(Hit);
+		if (Bits == 0) continue;
+		OutMask[Base / 32] |= Bits << (Base % 32);
+	}
+}
@@ -3,14 +3,37 @@
 
 #include "AdvPhysScene.h"
 
+#include "AdvPhysEvent_ForceField.h"
 #include "AdvPhysHashHelper.h"
+#include "AdvPhysSODKernel.h"
+#include "AdvPhysSceneFile.h"
+#include "AdvPhysStats.h"
+#include "AdvPhysBakeAsset.h"
+#include "AdvPhysBakeProfile.h"
+#include "AdvPhysBakeCacheSubsystem.h"
+#include "AdvPhysStreamingSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/UnrealNetwork.h"
+#include "PtouConversions.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#if WITH_EDITOR
+#include "EngineUtils.h"
+#endif
 
 // Sets default values
 AAdvPhysScene::AAdvPhysScene()
 {
 	SetRootComponent(CreateDefaultSubobject<USceneComponent>("Scene Root Component"));
 	PrimaryActorTick.bCanEverTick = true;
+	RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	Rebaker.Controller = nullptr;
 }
 
 void AAdvPhysScene::AddDynamicObj(UStaticMeshComponent* Component)
@@ -21,10 +44,23 @@ void AAdvPhysScene::AddDynamicObj(UStaticMeshComponent* Component)
 		return;
 	}
 	
-	RecordData = FPhysRecordData();
+	if (DynamicObjIndices.Contains(Component))
+	{
+		FMessageLog("AdvPhysScene").Warning(
+			FText::Format(
+				FText::FromString("Dynamic object {0} was already added."),
+				FText::FromName(FPhysObject::GetStableId(Component))
+			)
+		);
+		return;
+	}
+	
+	WaitForSODTask();
+	RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
 	Status = FStatus();
+	EventTimeline.Reset();
 	
-	DynamicObjEntries.Add(FPhysObject(Component));
+	DynamicObjIndices.Add(Component, DynamicObjEntries.Add(FPhysObject(Component)));
 
 	if (bFreezeDynamicObjectOnAdd)
 	{
@@ -40,17 +76,22 @@ void AAdvPhysScene::AddStaticObject(UStaticMeshComponent* Component)
 		return;
 	}
 	
-	RecordData = FPhysRecordData();
+	WaitForSODTask();
+	RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
 	Status = FStatus();
+	EventTimeline.Reset();
 	
 	StaticObjEntries.Add(FPhysObject(Component));
 }
 
 void AAdvPhysScene::ClearPhysObjects()
 {
-	RecordData = FPhysRecordData();
+	WaitForSODTask();
+	RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
 	Status = FStatus();
+	EventTimeline.Reset();
 	DynamicObjEntries.Empty();
+	DynamicObjIndices.Empty();
 	StaticObjEntries.Empty();
 	Simulator.ClearScene();
 }
@@ -91,19 +132,19 @@ void AAdvPhysScene::DrawSODObjectBounds()
 {
 	if (Status.Current != Playing) return;
 	
-	const float Now = GetWorld()->GetTimeSeconds();
-	const float CurrentTime = Now - Status.PlayStartTime;
+	const float CurrentTime = Status.PlayTime;
 
-	int FrameIndex = FMath::FloorToInt(CurrentTime / RecordData.FrameInterval);
-	if (FrameIndex >= RecordData.FrameCount)
-		FrameIndex = RecordData.FrameCount - 1;
+	int FrameIndex = FMath::FloorToInt(CurrentTime / RecordData->FrameInterval);
+	if (FrameIndex >= RecordData->FrameCount)
+		FrameIndex = RecordData->FrameCount - 1;
 	const size_t NumOfObjects = DynamicObjEntries.Num();
 
 	for (int i = 0; i < NumOfObjects; i++)
 	{
-		const auto& Frame = RecordData.ObjSOD[FrameIndex * NumOfObjects + i];
-		const auto BoundsCenter = Frame.Bounds.GetCenter();
-		const auto BoundsExtent = Frame.Bounds.GetExtent();
+		const auto& Frame = RecordData->ObjSOD[FrameIndex * NumOfObjects + i];
+		const auto Bounds = Status.bRelocated ? Frame.Bounds.TransformBy(Status.PlayTransform) : Frame.Bounds;
+		const auto BoundsCenter = Bounds.GetCenter();
+		const auto BoundsExtent = Bounds.GetExtent();
 		DrawDebugBox(GetWorld(), BoundsCenter, BoundsExtent, FColor::Green, false, 0);
 	}
 
@@ -115,7 +156,7 @@ void AAdvPhysScene::DrawSODObjectBounds()
 
 	for (int i = 0; i < Status.AddedActivators.Num(); i++)
 	{
-		const auto& Bounds = Status.AddedActivators[i]->Bounds.GetBox();
+		const auto& Bounds = Status.AddedActivators[i].Comp->Bounds.GetBox();
 		DrawDebugBox(GetWorld(), Bounds.GetCenter(), Bounds.GetExtent(), FColor::Orange, false, 0);
 	}
 }
@@ -124,33 +165,31 @@ void AAdvPhysScene::DrawSODHashCubes()
 {
 	if (Status.Current != Playing) return;
 	
-	const float Now = GetWorld()->GetTimeSeconds();
-	const float CurrentTime = Now - Status.PlayStartTime;
+	const float CurrentTime = Status.PlayTime;
 
-	int FrameIndex = FMath::FloorToInt(CurrentTime / RecordData.FrameInterval);
-	if (FrameIndex >= RecordData.FrameCount)
-		FrameIndex = RecordData.FrameCount - 1;
+	int FrameIndex = FMath::FloorToInt(CurrentTime / RecordData->FrameInterval);
+	if (FrameIndex >= RecordData->FrameCount)
+		FrameIndex = RecordData->FrameCount - 1;
 	const size_t NumOfObjects = DynamicObjEntries.Num();
 
 	for (int i = 0; i < NumOfObjects; i++)
 	{
-		const auto& Frame = RecordData.ObjSOD[FrameIndex * NumOfObjects + i];
+		const auto& Frame = RecordData->ObjSOD[FrameIndex * NumOfObjects + i];
 		unsigned StartXIndex, StartYIndex, StartZIndex, EndXIndex, EndYIndex, EndZIndex;
 		AdvPhysHashHelper::SplitFromHash(Frame.StartHash, StartXIndex, StartYIndex, StartZIndex);
 		AdvPhysHashHelper::SplitFromHash(Frame.EndHash, EndXIndex, EndYIndex, EndZIndex);
 
-		const double OffsetMetersFromCenter = RecordData.HashCellSize * WORLD_CELL_LENGTH / 2.0f;
-		FVector CellWorldStart = RecordData.HashWorldCenter - OffsetMetersFromCenter * FVector::OneVector;
+		const FVector CellWorldStart = AdvPhysHashHelper::GetCellWorldStart(RecordData->HashWorldCenter, RecordData->HashCellSize);
 		
 		FVector MinPoint = CellWorldStart
-			+ StartXIndex * FVector::ForwardVector * RecordData.HashCellSize
-			+ StartYIndex * FVector::RightVector * RecordData.HashCellSize
-			+ StartZIndex * FVector::UpVector * RecordData.HashCellSize;
+			+ StartXIndex * FVector::ForwardVector * RecordData->HashCellSize
+			+ StartYIndex * FVector::RightVector * RecordData->HashCellSize
+			+ StartZIndex * FVector::UpVector * RecordData->HashCellSize;
 		FVector MaxPoint = CellWorldStart
-			+ EndXIndex * FVector::ForwardVector * RecordData.HashCellSize
-			+ EndYIndex * FVector::RightVector * RecordData.HashCellSize
-			+ EndZIndex * FVector::UpVector * RecordData.HashCellSize
-			+ FVector::OneVector * RecordData.HashCellSize;
+			+ EndXIndex * FVector::ForwardVector * RecordData->HashCellSize
+			+ EndYIndex * FVector::RightVector * RecordData->HashCellSize
+			+ EndZIndex * FVector::UpVector * RecordData->HashCellSize
+			+ FVector::OneVector * RecordData->HashCellSize;
 		
 		const auto BoundsCenter = (MinPoint + MaxPoint) / 2;
 		const auto BoundsExtent = (MaxPoint - MinPoint) / 2;
@@ -170,6 +209,44 @@ void AAdvPhysScene::DrawSODActivatedObjects()
 	}
 }
 
+void AAdvPhysScene::DrawTelemetryGraph()
+{
+	const auto& Telemetry = RecordData->Telemetry;
+	if (Telemetry.Num() < 2) return;
+
+	float MaxSimulateTime = 0.0f;
+	int MaxAwakeBodies = 1;
+	for (const auto& Frame : Telemetry)
+	{
+		MaxSimulateTime = FMath::Max(MaxSimulateTime, Frame.SimulateTime);
+		MaxAwakeBodies = FMath::Max(MaxAwakeBodies, Frame.AwakeBodies);
+	}
+
+	// Frames along the scene's X axis, values up Z, each series scaled to its peak
+	const FVector Origin = GetActorLocation() + FVector(0.0f, 0.0f, TelemetryGraphSize.Y);
+	const FVector Right = GetActorForwardVector() * (TelemetryGraphSize.X / (Telemetry.Num() - 1));
+	const FVector Up = FVector::UpVector * TelemetryGraphSize.Y;
+	for (int i = 1; i < Telemetry.Num(); i++)
+	{
+		const float PrevTime = MaxSimulateTime > 0.0f ? Telemetry[i - 1].SimulateTime / MaxSimulateTime : 0.0f;
+		const float Time = MaxSimulateTime > 0.0f ? Telemetry[i].SimulateTime / MaxSimulateTime : 0.0f;
+		DrawDebugLine(GetWorld(), Origin + Right * (i - 1) + Up * PrevTime, Origin + Right * i + Up * Time, FColor::Red, false, 0);
+		DrawDebugLine(GetWorld(),
+			Origin + Right * (i - 1) + Up * (static_cast<float>(Telemetry[i - 1].AwakeBodies) / MaxAwakeBodies),
+			Origin + Right * i + Up * (static_cast<float>(Telemetry[i].AwakeBodies) / MaxAwakeBodies),
+			FColor::Green, false, 0);
+	}
+	DrawDebugLine(GetWorld(), Origin, Origin + Right * (Telemetry.Num() - 1), FColor::White, false, 0);
+
+	const int FrameIndex = FMath::Clamp(FMath::FloorToInt(Status.PlayTime / RecordData->FrameInterval), 0, Telemetry.Num() - 1);
+	const auto& Frame = Telemetry[FrameIndex];
+	DrawDebugLine(GetWorld(), Origin + Right * FrameIndex, Origin + Right * FrameIndex + Up, FColor::Yellow, false, 0);
+	DrawDebugString(GetWorld(), Origin + Right * FrameIndex + Up * 1.1f, FString::Printf(
+		TEXT("Frame %d: %.2fms, %d awake, %d contacts, %d narrowphase pairs, %d broadphase pairs, %d events (peak %.2fms)"),
+		FrameIndex, Frame.SimulateTime * 1000.0f, Frame.AwakeBodies, Frame.ContactPairs, Frame.NarrowphasePairs, Frame.BroadphasePairs, Frame.Events,
+		MaxSimulateTime * 1000.0f), nullptr, FColor::White, 0);
+}
+
 void AAdvPhysScene::Record(const float Interval, const int FrameCount)
 {
 	FMessageLog("AdvPhysScene").Info(
@@ -181,55 +258,240 @@ void AAdvPhysScene::Record(const float Interval, const int FrameCount)
 		)
 	);
 	
-	Cancel();
+	CancelInternal();
+	DeleteBakeSpill();
+	bBakeEvicted = false;
 	Status.Current = Recording;
-	RecordData = {};
-	RecordData.bEnableSOD = bEnableSOD;
-	RecordData.HashWorldCenter = GetActorLocation();
-	RecordData.HashCellSize = SODHashCellSize;
+	RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	RecordData->bEnableSOD = bEnableSOD;
+	RecordData->Origin = FTransform(GetActorRotation(), GetActorLocation());
+	for (const auto& Obj : DynamicObjEntries)
+	{
+		RecordData->ObjectIds.Add(Obj.Id);
+	}
+	RecordData->HashWorldCenter = GetActorLocation();
+	RecordData->HashCellSize = SODHashCellSize;
 	
+	if (bBakeInWorker)
+	{
+		RecordInWorker(Interval, FrameCount);
+		return;
+	}
+	// Determinism and profiles are properties of the PhysX scene, which is recreated empty
+	Simulator.SetDeterministic(bDeterministicBake);
+	Simulator.SetProfile(GetBakeProfile());
+	Simulator.ClearScene();
 	CopyObjectsToSimulator();
-	Simulator.ReserveEvents(FrameCount);
+	EventTimeline = MakeShared<const FPhysEventTimeline, ESPMode::ThreadSafe>(EventActors, Interval, FrameCount);
+	Simulator.SetEventTimeline(EventTimeline);
 
 	for (const auto& Actor : EventActors)
 	{
-		if (!Actor)
+		if (const auto Field = Cast<AAdvPhysEvent_ForceField>(Actor))
 		{
-			FMessageLog("AdvPhysScene").Error(FText::FromString("EventActors array contains invalid item"));
-			continue;
+			Simulator.AddForceField(Field, Interval, FrameCount);
 		}
-		Simulator.AddEvent(Actor->Time, Actor, Interval, FrameCount);
 	}
 	Simulator.Controller = Controller;
-	Simulator.StartRecord(&RecordData, Interval, FrameCount, GetWorld()->GetGravityZ());
+	Simulator.SetImpactRecording(bRecordImpacts, ImpactImpulseThreshold);
+	Simulator.SetIslandRecording(bEnableSOD && bSODActivateIslands);
+	Simulator.SetTelemetryRecording(bRecordTelemetry);
+	Simulator.SetStateHashRecording(bRecordStateHashes);
+	Simulator.StartRecord(RecordData.Get(), Interval, FrameCount, GetWorld()->GetGravityZ());
+	RecordStartTime = FPlatformTime::Seconds();
+}
+
+void AAdvPhysScene::BuildSceneDesc(float Interval, int FrameCount, FPhysSceneDesc& OutDesc)
+{
+	OutDesc.FrameInterval = Interval;
+	OutDesc.FrameCount = FrameCount;
+	OutDesc.GravityZ = GetWorld()->GetGravityZ();
+	OutDesc.bEnableSOD = bEnableSOD;
+	OutDesc.Origin = FTransform(GetActorRotation(), GetActorLocation());
+	OutDesc.HashWorldCenter = GetActorLocation();
+	OutDesc.HashCellSize = SODHashCellSize;
+	OutDesc.ObjectIds.Empty();
+	for (const auto& Obj : DynamicObjEntries)
+	{
+		OutDesc.ObjectIds.Add(Obj.Id);
+	}
+	OutDesc.bRecordImpacts = bRecordImpacts;
+	OutDesc.ImpactImpulseThreshold = ImpactImpulseThreshold;
+	OutDesc.bRecordIslands = bEnableSOD && bSODActivateIslands;
+	OutDesc.Profile = GetBakeProfile();
+	OutDesc.bRecordTelemetry = bRecordTelemetry;
+	OutDesc.bRecordStateHashes = bRecordStateHashes;
+	OutDesc.bDeterministic = bDeterministicBake;
+
+	// Shapes are cooked by the simulator, which is left empty again
+	Simulator.ClearScene();
+	CopyObjectsToSimulator();
+	Simulator.ExportScene(OutDesc);
+	Simulator.ClearScene();
+
+	OutDesc.Events.Empty();
+	for (const auto& Actor : EventActors)
+	{
+		if (Actor) Actor->ExportDesc(OutDesc.Events.AddDefaulted_GetRef());
+	}
+}
+
+bool AAdvPhysScene::ExportSceneFile(const FString& Path, float Interval, int FrameCount)
+{
+	if (Status.Current != Idle || !Simulator.IsInitialized())
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString("ExportSceneFile requires an idle scene that has begun play"));
+		return false;
+	}
+
+	FPhysSceneDesc Desc;
+	BuildSceneDesc(Interval, FrameCount, Desc);
+	const FString FullPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir(), Path);
+	if (!AdvPhysSceneFile::Save(FullPath, Desc))
+	{
+		FMessageLog("AdvPhysScene").Error(FText::Format(
+			FText::FromString("Could not write scene file {0}"),
+			FText::FromString(FullPath)
+			));
+		return false;
+	}
+	return true;
+}
+
+bool AAdvPhysScene::ExportTelemetry(const FString& Path)
+{
+	if (!RecordData->Finished || RecordData->Telemetry.Num() == 0)
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString("ExportTelemetry requires a finished bake recorded with bRecordTelemetry"));
+		return false;
+	}
+
+	FString Csv = TEXT("frame,simulate_ms,awake_bodies,contact_pairs,narrowphase_pairs,broadphase_pairs,events\n");
+	for (int i = 0; i < RecordData->Telemetry.Num(); i++)
+	{
+		const auto& Frame = RecordData->Telemetry[i];
+		Csv += FString::Printf(TEXT("%d,%f,%d,%d,%d,%d,%d\n"),
+			i, Frame.SimulateTime * 1000.0f, Frame.AwakeBodies, Frame.ContactPairs, Frame.NarrowphasePairs, Frame.BroadphasePairs, Frame.Events);
+	}
+	const FString FullPath = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir(), Path);
+	if (!FFileHelper::SaveStringToFile(Csv, *FullPath))
+	{
+		FMessageLog("AdvPhysScene").Error(FText::Format(
+			FText::FromString("Could not write telemetry file {0}"),
+			FText::FromString(FullPath)
+			));
+		return false;
+	}
+	return true;
+}
+
+void AAdvPhysScene::RecordInWorker(float Interval, int FrameCount)
+{
+	FPhysSceneDesc Desc;
+	BuildSceneDesc(Interval, FrameCount, Desc);
+
+	if (Controller)
+	{
+		FMessageLog("AdvPhysScene").Warning(FText::FromString("Controllers do not take part in bakes done by a worker"));
+	}
+	if (!WorkerClient.Start(BakeWorkerAddress, MoveTemp(Desc), RecordData))
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString(WorkerClient.GetError()));
+		Status = {};
+		RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+		return;
+	}
+	Status.bRecordingInWorker = true;
 	RecordStartTime = FPlatformTime::Seconds();
 }
 
 void AAdvPhysScene::Play()
 {
-	if (RecordData.FrameCount <= 0)
+	const bool bIsInstance = BakeSource && BakeSource != this;
+	if (bIsInstance && BakeSource->IsBakeEvicted())
+	{
+		// Playback starts once the source has its bake again
+		if (!bPlayOnBakeReload)
+		{
+			bPlayOnBakeReload = true;
+			BakeSource->BakeLoaded.AddUObject(this, &AAdvPhysScene::OnBakeSourceLoaded);
+		}
+		BakeSource->PrefetchBake();
+		return;
+	}
+	if (bBakeEvicted)
+	{
+		// Playback starts once the bake is resident again
+		bPlayOnBakeReload = true;
+		PrefetchBake();
+		return;
+	}
+	
+	const auto Bake = bIsInstance ? BakeSource->RecordData : RecordData;
+	if (Bake->FrameCount <= 0)
 	{
 		FMessageLog("AdvPhysScene").Error(FText::FromString("Tried to play with no recorded data."));
 		return;
 	}
+	if (bIsInstance && !Bake->Finished)
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString("Tried to play an instance of an unfinished bake."));
+		return;
+	}
+	if (Bake->ObjectCount != DynamicObjEntries.Num())
+	{
+		FMessageLog("AdvPhysScene").Error(
+			FText::Format(
+				FText::FromString("Tried to play a bake of {0} objects with {1} dynamic objects."),
+				Bake->ObjectCount,
+				DynamicObjEntries.Num()
+			)
+		);
+		return;
+	}
 	FMessageLog("AdvPhysScene").Info(
 		FText::Format(
 			FText::FromString("Start Playing, {0} objects, {1} frames, {2}s each."),
 			DynamicObjEntries.Num(),
-			RecordData.FrameCount,
-			RecordData.FrameInterval
+			Bake->FrameCount,
+			Bake->FrameInterval
 		)
 	);
 
-	Cancel();
+	CancelInternal();
+	// Instances follow their source, whose bake may have changed since the timeline was built
+	if (RecordData != Bake) EventTimeline.Reset();
+	RecordData = Bake;
 	Status.Current = Playing;
 	Status.PlayStartTime = GetWorld()->GetTimeSeconds();
+	Status.PlayTime = FMath::Clamp(PlayTimeOffset, 0.0f, GetDuration());
 	Status.LastPlayFrameTime = -1.0f;
-	Status.PlayEventActors = EventActors;
+	if (!PlaybackGroup.IsNone())
+	{
+		// Join a group already playing in other cells, or start its clock
+		const auto Streaming = GetWorld()->GetSubsystem<UAdvPhysStreamingSubsystem>();
+		float GroupTime;
+		if (Streaming->GetGroupPlayTime(PlaybackGroup, GroupTime))
+			Status.PlayTime = FMath::Clamp(GroupTime, 0.0f, GetDuration());
+		else
+			Streaming->StartGroup(PlaybackGroup, Status.PlayTime, PlaybackRate);
+	}
+	if (!EventTimeline)
+	{
+		EventTimeline = MakeShared<const FPhysEventTimeline, ESPMode::ThreadSafe>(EventActors, RecordData->FrameInterval, RecordData->FrameCount);
+	}
+	Status.EventCursor = EventTimeline->Seek(Status.PlayTime);
+	Status.ImpactFrameCursor = FMath::CeilToInt(Status.PlayTime / RecordData->FrameInterval);
+
+	// Baked poses are moved along with the actor relative to where the bake was recorded
+	Status.PlayTransform = RecordData->Origin.Inverse() * FTransform(GetActorRotation(), GetActorLocation());
+	Status.InversePlayTransform = Status.PlayTransform.Inverse();
+	Status.bRelocated = !Status.PlayTransform.Equals(FTransform::Identity);
 	
-	if (RecordData.bEnableSOD)
+	if (RecordData->bEnableSOD)
 	{
 		Status.SODActivationState.AddZeroed(DynamicObjEntries.Num());
+		Status.SODWorkspace = MakeShared<FSODWorkspace>();
 		Status.LastSODCheckTime = -1.0f;
 	}
 	
@@ -238,7 +500,9 @@ void AAdvPhysScene::Play()
 		Obj.Comp->SetSimulatePhysics(false);
 		Obj.Comp->SetCollisionProfileName(TEXT("OverlapAll"));
 	}
-	PlayFrame(0.0f);
+	PlayFrame(Status.PlayTime);
+	GetWorld()->GetSubsystem<UAdvPhysBakeCacheSubsystem>()->Touch(bIsInstance ? BakeSource : this);
+	UpdateReplicatedPlayback(true);
 
 	if (Controller) Controller->BeginPlayScene(this);
 }
@@ -250,21 +514,114 @@ void AAdvPhysScene::PlayRealtimeSimulation()
 	Status.Current = PlayingRealtimeSimulation;
 	Status.PlayStartTime = GetWorld()->GetTimeSeconds();
 	Status.LastPlayFrameTime = -1.0f;
-	Status.PlayEventActors = EventActors;
+	// Realtime simulation has no bake to share a timeline with
+	EventTimeline = MakeShared<const FPhysEventTimeline, ESPMode::ThreadSafe>(EventActors, 0.0f, 0);
+	Status.EventCursor = 0;
+
+	// Events find the objects they affect by overlapping the object types of the dynamic objects
+	EventQueryParams = FCollisionObjectQueryParams();
+	for (const auto& Obj : DynamicObjEntries)
+	{
+		EventQueryParams.AddObjectTypesToQuery(Obj.Comp->GetCollisionObjectType());
+		if (CollisionEnabledHasQuery(Obj.Comp->GetCollisionEnabled())) continue;
+		FMessageLog("AdvPhysScene").Warning(
+			FText::Format(
+				FText::FromString("Dynamic object {0} has queries disabled and is not affected by events in realtime simulation."),
+				FText::FromName(Obj.Id)
+			)
+		);
+	}
 }
 
-void AAdvPhysScene::Cancel()
+void AAdvPhysScene::Seek(float Time)
 {
-	ResetPhysObjectsPosition();
-	if (Simulator.IsRecording())
+	if (Status.Current != Playing)
 	{
-		Simulator.StopRecord();
-		while (Simulator.IsRecording())
-		{
-			// Spin lock TODO
-		}
+		Play();
+		if (Status.Current != Playing) return;
+	}
+
+	// Events before the target count as triggered without being broadcast again
+	Status.PlayTime = FMath::Clamp(Time, 0.0f, GetDuration());
+	Status.EventCursor = EventTimeline->Seek(Status.PlayTime);
+	Status.ImpactFrameCursor = FMath::CeilToInt(Status.PlayTime / RecordData->FrameInterval);
+	if (RecordData->bEnableSOD)
+	{
+		ResetSODState();
+	}
+	PlayFrame(Status.PlayTime);
+	Status.LastPlayFrameTime = GetWorld()->GetTimeSeconds();
+	SetPlaybackGroupClock();
+	UpdateReplicatedPlayback(true);
+}
+
+void AAdvPhysScene::SetPlaybackRate(float Rate)
+{
+	PlaybackRate = Rate;
+	if (Status.Current == Playing) SetPlaybackGroupClock();
+	UpdateReplicatedPlayback(false);
+}
+
+float AAdvPhysScene::GetPlaybackRate() const
+{
+	return PlaybackRate;
+}
+
+float AAdvPhysScene::GetPlayTime() const
+{
+	return Status.PlayTime;
+}
+
+void AAdvPhysScene::ResetSODState()
+{
+	WaitForSODTask();
+	for (int ObjIndex = 0; ObjIndex < Status.SODActivationState.Num(); ObjIndex++)
+	{
+		if (!Status.SODActivationState[ObjIndex]) continue;
+		const auto& Comp = DynamicObjEntries[ObjIndex].Comp;
+		Comp->SetSimulatePhysics(false);
+		Comp->SetCollisionProfileName(TEXT("OverlapAll"));
+		Status.SODActivationState[ObjIndex] = false;
 	}
+	Status.AddedActivators.Empty();
+	Status.AddedActivatorSet.Empty();
+
+	// Re-baked tracks started from states that no longer exist
+	Status.TrackOverrides.Empty();
+	Status.OverrideSlots.Reset();
+	Status.OverrideTracks.Reset();
+	StopLocalRebake();
+}
+
+void AAdvPhysScene::Cancel()
+{
+	// Stops every cell of the group, unlike streaming out which leaves the clock running for cells still loaded or coming back
+	if (Status.Current == Playing) StopPlaybackGroup();
+	CancelInternal();
+}
+
+void AAdvPhysScene::CancelInternal()
+{
+	WaitForSODTask();
+	ResetPhysObjectsPosition();
+	WorkerClient.Stop();
+	Simulator.StopRecordAndWait();
+	// The realtime timeline has no frames, playback of a bake builds its own
+	if (Status.Current == PlayingRealtimeSimulation) EventTimeline.Reset();
 	Status = {};
+	UpdateReplicatedPlayback(false);
+}
+
+void AAdvPhysScene::StopPlaybackGroup()
+{
+	if (PlaybackGroup.IsNone()) return;
+	GetWorld()->GetSubsystem<UAdvPhysStreamingSubsystem>()->StopGroup(PlaybackGroup);
+}
+
+void AAdvPhysScene::SetPlaybackGroupClock()
+{
+	if (PlaybackGroup.IsNone()) return;
+	GetWorld()->GetSubsystem<UAdvPhysStreamingSubsystem>()->SetGroupClock(PlaybackGroup, Status.PlayTime, PlaybackRate);
 }
 
 void AAdvPhysScene::FreezeDynamicObjects()
@@ -301,7 +658,7 @@ EAction AAdvPhysScene::GetAction() const
 
 float AAdvPhysScene::GetRecordProgress() const
 {
-	return RecordData.Progress;
+	return RecordData->Progress;
 }
 
 int AAdvPhysScene::GetNumOfActivators() const
@@ -316,17 +673,120 @@ float AAdvPhysScene::GetPlayFramesPerSecond() const
 
 int AAdvPhysScene::GetRecordDataFrameCount() const
 {
-	return RecordData.FrameCount;
+	return RecordData->FrameCount;
 }
 
 float AAdvPhysScene::GetRecordDataFrameInterval() const
 {
-	return RecordData.FrameInterval;
+	return RecordData->FrameInterval;
 }
 
 bool AAdvPhysScene::GetRecordDataFinished() const
 {
-	return RecordData.Finished;
+	return RecordData->Finished;
+}
+
+int64 AAdvPhysScene::GetBakeMemorySize() const
+{
+	return RecordData->GetAllocatedSize() + GetBakePayloadSize();
+}
+
+int64 AAdvPhysScene::GetBakePayloadSize() const
+{
+	const UAdvPhysBakeAsset* Asset = EmbeddedBake ? EmbeddedBake : BakeAsset.Get();
+	return Asset ? Asset->GetResidentPayloadSize() : 0;
+}
+
+bool AAdvPhysScene::IsBakeEvicted() const
+{
+	return bBakeEvicted;
+}
+
+bool AAdvPhysScene::CanEvictBake() const
+{
+	// Bakes still referenced by playing instances would stay in memory anyway
+	return !bBakeEvicted && Status.Current == Idle && RecordData->Finished && RecordData.GetSharedReferenceCount() == 1;
+}
+
+const void* AAdvPhysScene::GetBakeIdentity() const
+{
+	return RecordData.Get();
+}
+
+void AAdvPhysScene::EvictBake()
+{
+	if (!CanEvictBake()) return;
+	
+	if (!EmbeddedBake && BakeAsset.IsNull() && BakeSpillPath.IsEmpty())
+	{
+		// Recorded at runtime, there is nothing to read it again from but a copy on disk
+		BakeSpillPath = FPaths::ProjectSavedDir() / TEXT("AdvPhysBakes") / FString::Printf(TEXT("%s_%s.bake"), *GetName(), *FGuid::NewGuid().ToString());
+		SpillingBake = RecordData;
+		Async(EAsyncExecution::ThreadPool, [Data = RecordData, Path = BakeSpillPath]()
+		{
+			TArray<uint8> Bytes;
+			FMemoryWriter Writer(Bytes, true);
+			Writer << *Data;
+			FFileHelper::SaveArrayToFile(Bytes, *Path);
+		});
+	}
+	
+	RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	EventTimeline.Reset();
+	bBakeEvicted = true;
+}
+
+void AAdvPhysScene::PrefetchBake()
+{
+	if (!bBakeEvicted || bBakeReloading) return;
+	bBakeReloading = true;
+
+	if (const auto Spilling = SpillingBake.Pin())
+	{
+		SetBakeData(Spilling);
+		return;
+	}
+	if (EmbeddedBake)
+	{
+		ReadBakeAsset(EmbeddedBake);
+		return;
+	}
+	if (!BakeAsset.IsNull())
+	{
+		LoadBakeAsset();
+		return;
+	}
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis = TWeakObjectPtr<AAdvPhysScene>(this), Path = BakeSpillPath]()
+	{
+		TArray<uint8> Bytes;
+		FPhysRecordDataPtr Data;
+		if (FFileHelper::LoadFileToArray(Bytes, *Path))
+		{
+			Data = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+			FMemoryReader Reader(Bytes, true);
+			Reader << *Data;
+		}
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Data]()
+		{
+			if (!WeakThis.IsValid()) return;
+			if (!Data)
+			{
+				WeakThis->bBakeReloading = false;
+				FMessageLog("AdvPhysScene").Error(FText::FromString("Failed to reload evicted bake."));
+				return;
+			}
+			WeakThis->SetBakeData(Data);
+		});
+	});
+}
+
+void AAdvPhysScene::DeleteBakeSpill()
+{
+	if (BakeSpillPath.IsEmpty()) return;
+	IFileManager::Get().Delete(*BakeSpillPath);
+	BakeSpillPath.Empty();
+	SpillingBake.Reset();
 }
 
 bool AAdvPhysScene::GetEnableSOD() const
@@ -346,32 +806,37 @@ void AAdvPhysScene::SetNaiveSODCheck(bool bNaive)
 
 float AAdvPhysScene::GetDuration() const
 {
-	return RecordData.FrameCount * RecordData.FrameInterval;
+	return RecordData->FrameCount * RecordData->FrameInterval;
 }
 
 void AAdvPhysScene::PlayFrame(float Time)
 {
-	const float Frame = Time / RecordData.FrameInterval;
+	ADVPHYS_SCOPE_CYCLE(AdvPhysPlayFrame);
+	const float Frame = Time / RecordData->FrameInterval;
 	int StartFrame = FMath::FloorToInt(Frame);
 	int EndFrame = FMath::CeilToInt(Frame);
 
-	if (StartFrame >= RecordData.FrameCount)
-		StartFrame = RecordData.FrameCount - 1;
-	if (EndFrame >= RecordData.FrameCount)
-		EndFrame = RecordData.FrameCount - 1;
+	if (StartFrame >= RecordData->FrameCount)
+		StartFrame = RecordData->FrameCount - 1;
+	if (EndFrame >= RecordData->FrameCount)
+		EndFrame = RecordData->FrameCount - 1;
 
 	const size_t NumOfObjects = DynamicObjEntries.Num();
+	int NumOfUpdated = 0;
 
 	// Set location/rotation as-is
 	if (!bEnableInterpolation || StartFrame == EndFrame)
 	{
 		for (int ObjIndex = 0; ObjIndex < NumOfObjects; ObjIndex++)
 		{
-			if (RecordData.bEnableSOD && Status.SODActivationState[ObjIndex]) continue;
-			const FPhysObjLocRot& StartEntry = RecordData.ObjLocRot[StartFrame * NumOfObjects + ObjIndex];
-
-			DynamicObjEntries[ObjIndex].Comp->SetWorldLocationAndRotationNoPhysics(StartEntry.Location, StartEntry.Rotation);
+			if (RecordData->bEnableSOD && Status.SODActivationState[ObjIndex]) continue;
+			FVector Loc;
+			FRotator Rot;
+			GetPlayPose(ObjIndex, StartFrame, Loc, Rot);
+			DynamicObjEntries[ObjIndex].Comp->SetWorldLocationAndRotationNoPhysics(Loc, Rot);
+			NumOfUpdated++;
 		}
+		ADVPHYS_COUNTER_ADD(AdvPhysObjectsUpdated, NumOfUpdated);
 		return;
 	}
 
@@ -379,153 +844,417 @@ void AAdvPhysScene::PlayFrame(float Time)
 	const float Value = Frame - StartFrame;
 	for (int ObjIndex = 0; ObjIndex < NumOfObjects; ObjIndex++)
 	{
-		if (RecordData.bEnableSOD && Status.SODActivationState[ObjIndex]) continue;
-		const FPhysObjLocRot& StartEntry = RecordData.ObjLocRot[StartFrame * NumOfObjects + ObjIndex];
-		const FPhysObjLocRot& EndEntry = RecordData.ObjLocRot[EndFrame * NumOfObjects + ObjIndex];
-
-		const FVector Loc = StartEntry.Location * (1.0f - Value) + EndEntry.Location * Value;
-		const FRotator Rot = FMath::Lerp(StartEntry.Rotation, EndEntry.Rotation, Value);
-
+		if (RecordData->bEnableSOD && Status.SODActivationState[ObjIndex]) continue;
+		FVector StartLoc, EndLoc;
+		FRotator StartRot, EndRot;
+		GetPlayPose(ObjIndex, StartFrame, StartLoc, StartRot);
+		GetPlayPose(ObjIndex, EndFrame, EndLoc, EndRot);
+
+		const FVector Loc = StartLoc * (1.0f - Value) + EndLoc * Value;
+		const FRotator Rot = FMath::Lerp(StartRot, EndRot, Value);
 		DynamicObjEntries[ObjIndex].Comp->SetWorldLocationAndRotationNoPhysics(Loc, Rot);
+		NumOfUpdated++;
+	}
+	ADVPHYS_COUNTER_ADD(AdvPhysObjectsUpdated, NumOfUpdated);
+}
+
+void AAdvPhysScene::GetPlayPose(int ObjIndex, int FrameIndex, FVector& Location, FRotator& Rotation) const
+{
+	const int Slot = Status.OverrideSlots.Num() > 0 ? Status.OverrideSlots[ObjIndex] : INDEX_NONE;
+	if (Slot != INDEX_NONE)
+	{
+		const auto& Override = Status.TrackOverrides[Slot];
+		const int LocalFrame = FrameIndex - Override.StartFrame;
+		if (LocalFrame >= 0 && LocalFrame < Override.FrameCount)
+		{
+			const auto& Entry = Override.Data->ObjLocRot[LocalFrame * Override.Data->ObjectCount + Status.OverrideTracks[ObjIndex]];
+			Location = Entry.Location;
+			Rotation = Entry.Rotation;
+			return;
+		}
 	}
+	
+	const auto& Entry = RecordData->ObjLocRot[FrameIndex * DynamicObjEntries.Num() + ObjIndex];
+	Location = Entry.Location;
+	Rotation = Entry.Rotation;
+	ToPlaySpace(Location, Rotation);
+}
+
+void AAdvPhysScene::ToPlaySpace(FVector& Location, FRotator& Rotation) const
+{
+	if (!Status.bRelocated) return;
+	Location = Status.PlayTransform.TransformPosition(Location);
+	Rotation = (Status.PlayTransform.GetRotation() * Rotation.Quaternion()).Rotator();
 }
 
 void AAdvPhysScene::HandleEventsInFrame(float Time, bool ApplyEventsToRealWorld)
 {
+	if (!EventTimeline) return;
+	const auto& Timeline = *EventTimeline;
+	
 	// This is only called when playing recorded bake data.
 	// Because playing via Realtime Simulation does not specify its duration -> hence duration unknown. 
 	if (!ApplyEventsToRealWorld && Time > GetDuration())
 	{
-		for (const auto& Actor : Status.PlayEventActors)
+		for (; Status.EventCursor < Timeline.Num(); Status.EventCursor++)
 		{
-			Actor->BroadcastOnTrigger();
+			Timeline[Status.EventCursor].EventActor->BroadcastOnTrigger();
 		}
-		Status.PlayEventActors.Empty();
 		return;
 	}
 
-	for (int i = Status.PlayEventActors.Num() - 1; i >= 0; i--)
+	for (; Status.EventCursor < Timeline.Num() && Timeline[Status.EventCursor].Time <= Time; Status.EventCursor++)
 	{
-		const auto& E = Status.PlayEventActors[i];
-		if (E->Time > Time) continue;
+		const auto& E = Timeline[Status.EventCursor].EventActor;
 		E->BroadcastOnTrigger();
 		if (ApplyEventsToRealWorld)
 		{
-			E->DoEventUE(DynamicObjEntries);
+			E->DoEventUE(QueryEventObjects(E));
 		}
-		Status.PlayEventActors.RemoveAt(i);
 	}
 }
 
-void AAdvPhysScene::CheckSODAtTime(float Time)
+TArrayView<const FPhysObject> AAdvPhysScene::QueryEventObjects(const AAdvPhysEventBase* Event)
 {
-	const float Frame = Time / RecordData.FrameInterval;
-	int FrameIndex = FMath::FloorToInt(Frame);
-	if (FrameIndex >= RecordData.FrameCount)
-		FrameIndex = RecordData.FrameCount - 1;
-	
-	const auto NumOfObjects = DynamicObjEntries.Num();
-	if (bUseNaiveSODCheck)
+	FVector Center;
+	float Radius;
+	if (!Event->GetInfluenceSphere(Center, Radius))
 	{
-		for (int i = 0; i < NumOfObjects; i++)
-		{
-			if (Status.SODActivationState[i]) continue;
+		return DynamicObjEntries;
+	}
 
-			for (const auto& Act : OriginalActivators)
-			{
-				if (!CheckActivatorIntersect(Act, RecordData.ObjSOD[FrameIndex * NumOfObjects + i], true)) continue;
-				SimulateObjectOnDemand(i, FrameIndex);
-				break;
-			}
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Center, FQuat::Identity, EventQueryParams, FCollisionShape::MakeSphere(Radius));
 
-			// Don't use iterator as items are added while iteration
-			const auto Num = Status.AddedActivators.Num();
-			for (int j = 0; j < Num; j++)
-			{
-				const auto& Act = Status.AddedActivators[j];
-				if (!CheckActivatorIntersect(Act, RecordData.ObjSOD[FrameIndex * NumOfObjects + i], false)) continue;
-				SimulateObjectOnDemand(i, FrameIndex);
-				break;
-			}
+	EventObjects.Reset();
+	for (const auto& Overlap : Overlaps)
+	{
+		const int* ObjIndex = DynamicObjIndices.Find(Overlap.GetComponent());
+		if (!ObjIndex) continue;
+		EventObjects.Add(DynamicObjEntries[*ObjIndex]);
+	}
+	return EventObjects;
+}
+
+void AAdvPhysScene::DispatchImpacts(float Time)
+{
+	if (!RecordData->HasImpacts()) return;
+	const int FrameIndex = FMath::Min(FMath::FloorToInt(Time / RecordData->FrameInterval), RecordData->FrameCount - 1);
+	if (FrameIndex < Status.ImpactFrameCursor) return;
+
+	bool bCull = false;
+	FVector ViewLocation;
+	if (ImpactCullDistance > 0)
+	{
+		if (const auto PlayerController = GetWorld()->GetFirstPlayerController())
+		{
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			bCull = true;
+		}
+	}
+
+	// Every frame passed since the last dispatch, so throttled playback does not drop impacts
+	const int Begin = RecordData->ImpactFrameStarts[Status.ImpactFrameCursor];
+	const int End = RecordData->ImpactFrameStarts[FrameIndex + 1];
+	Status.ImpactFrameCursor = FrameIndex + 1;
+	for (int i = Begin; i < End; i++)
+	{
+		FPhysImpactEvent Impact = RecordData->Impacts[i];
+		
+		// Activated objects collide for real
+		if (RecordData->bEnableSOD)
+		{
+			if (Impact.ObjA != INDEX_NONE && Status.SODActivationState[Impact.ObjA]) continue;
+			if (Impact.ObjB != INDEX_NONE && Status.SODActivationState[Impact.ObjB]) continue;
 		}
+
+		FVector Location(Impact.Location);
+		FRotator Rotation = FRotator::ZeroRotator;
+		ToPlaySpace(Location, Rotation);
+		if (bCull && FVector::DistSquared(Location, ViewLocation) > FMath::Square(ImpactCullDistance)) continue;
+		
+		Impact.Location = FVector3f(Location);
+		ImpactPlayed.Broadcast(Impact);
+		if (Controller) Controller->DidPlayImpact(this, Impact);
+	}
+}
+
+void AAdvPhysScene::CheckSODAtTime(float Time)
+{
+	ADVPHYS_SCOPE_CYCLE(AdvPhysSODCheck);
+	const float Frame = Time / RecordData->FrameInterval;
+	int FrameIndex = FMath::FloorToInt(Frame);
+	if (FrameIndex >= RecordData->FrameCount)
+		FrameIndex = RecordData->FrameCount - 1;
+
+	// The previous background check has not been applied yet
+	if (Status.SODTask.IsValid()) return;
+
+	UpdateActivators();
+	if (Status.ActivatorBounds.Num() == 0) return;
+
+	auto& Workspace = *Status.SODWorkspace;
+	Workspace.ActivatorBounds = Status.ActivatorBounds;
+	Workspace.ActivationState = Status.SODActivationState;
+	Workspace.Activated.Reset();
+
+	if (bAsyncSODCheck)
+	{
+		Status.SODTask = Async(EAsyncExecution::TaskGraph, [this, FrameIndex, WorkspacePtr = Status.SODWorkspace]()
+		{
+			DetectSOD(FrameIndex, *WorkspacePtr);
+			return FrameIndex;
+		});
 		return;
 	}
 	
-	RebuildSODMap(FrameIndex);
-
-	for (const auto& Act : OriginalActivators)
+	DetectSOD(FrameIndex, Workspace);
+	ExpandToIslands(FrameIndex, Workspace.Activated);
+	ADVPHYS_COUNTER_ADD(AdvPhysObjectsActivated, Workspace.Activated.Num());
+	for (const int ObjIndex : Workspace.Activated)
 	{
-		CheckFromSODMap(Act, FrameIndex, true);
+		SimulateObjectOnDemand(ObjIndex, FrameIndex);
 	}
-	const auto Num = Status.AddedActivators.Num();
-	for (int i = 0; i < Num; i++)
+	StartLocalRebake(FrameIndex, Workspace.Activated);
+}
+
+void AAdvPhysScene::ApplyAsyncSODResult(int FrameIndex)
+{
+	if (!Status.SODTask.IsValid() || !Status.SODTask.IsReady()) return;
+	Status.SODTask.Reset();
+
+	// Objects are activated at the frame being played now rather than the one they were detected at
+	ExpandToIslands(FrameIndex, Status.SODWorkspace->Activated);
+	int NumOfActivated = 0;
+	for (const int ObjIndex : Status.SODWorkspace->Activated)
 	{
-		const auto& Act = Status.AddedActivators[i];
-		CheckFromSODMap(Act, FrameIndex, false);
+		if (Status.SODActivationState[ObjIndex]) continue;
+		SimulateObjectOnDemand(ObjIndex, FrameIndex);
+		NumOfActivated++;
 	}
+	ADVPHYS_COUNTER_ADD(AdvPhysObjectsActivated, NumOfActivated);
+	StartLocalRebake(FrameIndex, Status.SODWorkspace->Activated);
 }
 
-bool AAdvPhysScene::CheckActivatorIntersect(const USceneComponent* Activator, const FPhysObjSODData& SODData, const bool bIsOriginal) const
+void AAdvPhysScene::WaitForSODTask()
 {
-	const auto ActBox = Activator->Bounds.GetBox();
-	return ActBox.ExpandBy(bIsOriginal ? SODOriginalActivatorBoundExpansion : SODAddedActivatorBoundExpansion).Intersect(SODData.Bounds);
+	if (!Status.SODTask.IsValid()) return;
+	Status.SODTask.Wait();
+	Status.SODTask.Reset();
 }
 
-void AAdvPhysScene::RebuildSODMap(int FrameIndex)
+void AAdvPhysScene::DetectSOD(const int FrameIndex, FSODWorkspace& Workspace) const
 {
-	auto& Map = Status.SODMap;
-	Map.clear();
 	const auto NumOfObjects = DynamicObjEntries.Num();
-	
-	for (int i = 0; i < NumOfObjects; i++)
+	if (bUseNaiveSODCheck)
 	{
-		if (Status.SODActivationState[i]) continue;;
-		const auto& SODData = RecordData.ObjSOD[FrameIndex * NumOfObjects + i];
+		const int Stride = RecordData->SODSoAStride;
+		AdvPhysSODKernel::OverlapActivators(&RecordData->ObjSODSoA[FrameIndex * SOD_SOA_PLANES * Stride], Stride,
+			Workspace.ActivatorBounds, Workspace.SODActivationMask);
 		
-		auto UpdateMap = [&Map, &i](uint32 Hash)
+		for (int Word = 0; Word < Workspace.SODActivationMask.Num(); Word++)
 		{
-			const auto FindIter = Map.find(Hash);
-			if (FindIter != Map.end())
+			uint32 Bits = Workspace.SODActivationMask[Word];
+			while (Bits)
 			{
-				FindIter->second.push_back(i);
-				return;
+				const int i = Word * 32 + FMath::CountTrailingZeros(Bits);
+				Bits &= Bits - 1;
+				if (i >= NumOfObjects || Workspace.ActivationState[i]) continue;
+				Workspace.ActivationState[i] = true;
+				Workspace.Activated.Add(i);
 			}
-			std::list<int> NewList;
-			NewList.push_back(i);
-			Map.insert(std::hash_map<uint32, std::list<int>>::value_type(Hash, std::move(NewList)));
-		};
-		AdvPhysHashHelper::CubicSweepHash(SODData.StartHash, SODData.EndHash, UpdateMap);
+		}
+		return;
 	}
+	
+	RebuildSODMap(FrameIndex, Workspace);
+	CheckFromSODMap(FrameIndex, Workspace);
 }
 
-void AAdvPhysScene::CheckFromSODMap(const USceneComponent* Activator, const int FrameIndex, const bool bIsOriginal)
+void AAdvPhysScene::UpdateActivators()
 {
-	const auto NumOfObjects = DynamicObjEntries.Num();
-	uint32 StartHash, EndHash;
-	AdvPhysHashHelper::GetHash(Activator->Bounds.GetBox().ExpandBy(
-		bIsOriginal ? SODOriginalActivatorBoundExpansion : SODAddedActivatorBoundExpansion),
-		RecordData.HashWorldCenter, RecordData.HashCellSize,
-		StartHash, EndHash);
-		
-	auto CheckForActivation = [&](uint32 Hash)
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (int i = Status.AddedActivators.Num() - 1; i >= 0; i--)
 	{
-		const auto& Map = Status.SODMap;
-		const auto FindIter = Map.find(Hash);
-		if (FindIter == Map.end()) return;
-		for (const int ObjIndex : FindIter->second)
+		const auto& Act = Status.AddedActivators[i];
+		if (!ShouldRetireActivator(Act, Now)) continue;
+		Status.AddedActivatorSet.Remove(Act.Comp);
+		Status.AddedActivators.RemoveAt(i);
+	}
+
+	auto& Boxes = Status.ActivatorBounds;
+	Boxes.Reset();
+	for (const auto& Act : OriginalActivators)
+	{
+		Boxes.Add(ToBakeSpace(Act->Bounds.GetBox()).ExpandBy(SODOriginalActivatorBoundExpansion));
+	}
+
+	// Added activators tend to pile up around the same spot in a chain reaction, fold overlapping ones together
+	// as long as the merged box does not cover much more than the boxes it replaces, or it would activate everything in between
+	const double MaxMergeGrowth = 2.0;
+	TArray<FBox, TInlineAllocator<32>> Added;
+	for (const auto& Act : Status.AddedActivators)
+	{
+		Added.Add(ToBakeSpace(Act.Comp->Bounds.GetBox()).ExpandBy(SODAddedActivatorBoundExpansion));
+	}
+	Added.Sort([](const FBox& A, const FBox& B) { return A.Min.X < B.Min.X; });
+
+	// Sweep along X, boxes ending before the current one starts can no longer merge with anything
+	const int NumOfOriginals = Boxes.Num();
+	TArray<double, TInlineAllocator<32>> Volumes;
+	TArray<int, TInlineAllocator<32>> Open;
+	for (const auto& Box : Added)
+	{
+		Open.RemoveAllSwap([&Boxes, &Box](int Index) { return Boxes[Index].Max.X < Box.Min.X; });
+
+		const double Volume = Box.GetVolume();
+		bool bMerged = false;
+		for (const int Index : Open)
 		{
-			if (Status.SODActivationState[ObjIndex]) continue;
-			if (!CheckActivatorIntersect(Activator, RecordData.ObjSOD[FrameIndex * NumOfObjects + ObjIndex], bIsOriginal)) continue;
-			SimulateObjectOnDemand(ObjIndex, FrameIndex);
+			if (!Boxes[Index].Intersect(Box)) continue;
+			const FBox Union = Boxes[Index] + Box;
+			const double SummedVolume = Volumes[Index - NumOfOriginals] + Volume;
+			if (Union.GetVolume() > SummedVolume * MaxMergeGrowth) continue;
+			Boxes[Index] = Union;
+			Volumes[Index - NumOfOriginals] = SummedVolume;
+			bMerged = true;
+			break;
 		}
-	};
-	AdvPhysHashHelper::CubicSweepHash(StartHash, EndHash, CheckForActivation);
+		if (bMerged) continue;
+		Open.Add(Boxes.Add(Box));
+		Volumes.Add(Volume);
+	}
 }
 
-void AAdvPhysScene::SimulateObjectOnDemand(int ObjIndex, int FrameIndex)
+FBox AAdvPhysScene::ToBakeSpace(const FBox& Box) const
 {
-	Status.SODActivationState[ObjIndex] = true;
+	return Status.bRelocated ? Box.TransformBy(Status.InversePlayTransform) : Box;
+}
+
+bool AAdvPhysScene::ShouldRetireActivator(const FSODActivator& Activator, float Now) const
+{
+	if (!IsValid(Activator.Comp)) return true;
+	if (SODAddedActivatorLifetime > 0 && Now - Activator.AddedTime > SODAddedActivatorLifetime) return true;
 	
+	// Freshly activated bodies may not have woken up yet
+	if (Now - Activator.AddedTime < RecordData->FrameInterval) return false;
+	const auto Prim = Cast<UPrimitiveComponent>(Activator.Comp);
+	return Prim && !Prim->IsAnyRigidBodyAwake();
+}
+
+void AAdvPhysScene::RebuildSODMap(int FrameIndex, FSODWorkspace& Workspace) const
+{
+	ADVPHYS_SCOPE_CYCLE(AdvPhysSODRebuildMap);
+	auto& Map = Workspace.SODMap;
+	Map.clear();
+	const auto NumOfObjects = DynamicObjEntries.Num();
+	const int MaxCellSpan = GetSODMaxCellSpan();
+	const unsigned CoarseShift = GetSODCoarseShift();
+
+	// Wide activators only sweep the coarse level, where small objects are then needed as well
+	bool bWideActivators = false;
+	for (int i = 0; MaxCellSpan > 0 && i < Workspace.ActivatorBounds.Num() && !bWideActivators; i++)
+	{
+		uint64 StartHash, EndHash;
+		AdvPhysHashHelper::GetHash(Workspace.ActivatorBounds[i],
+			RecordData->HashWorldCenter, RecordData->HashCellSize,
+			StartHash, EndHash);
+		bWideActivators = AdvPhysHashHelper::GetMaxCellSpan(StartHash, EndHash) > static_cast<unsigned>(MaxCellSpan);
+	}
+	
+	for (int i = 0; i < NumOfObjects; i++)
+	{
+		if (Workspace.ActivationState[i]) continue;
+		const auto& SODData = RecordData->ObjSOD[FrameIndex * NumOfObjects + i];
+		
+		auto UpdateMap = [&Map, &i](uint64 Hash)
+		{
+			Map[Hash].push_back(i);
+		};
+
+		// Large objects only occupy the few coarse cells they touch
+		const bool bWide = MaxCellSpan > 0 && AdvPhysHashHelper::GetMaxCellSpan(SODData.StartHash, SODData.EndHash) > static_cast<unsigned>(MaxCellSpan);
+		if (bWide || bWideActivators)
+		{
+			AdvPhysHashHelper::CubicSweepHash(
+				AdvPhysHashHelper::ToCoarseHash(SODData.StartHash, CoarseShift),
+				AdvPhysHashHelper::ToCoarseHash(SODData.EndHash, CoarseShift),
+				UpdateMap);
+		}
+		if (bWide) continue;
+		AdvPhysHashHelper::CubicSweepHash(SODData.StartHash, SODData.EndHash, UpdateMap);
+	}
+	ADVPHYS_COUNTER_SET(AdvPhysSODMapCells, Map.size());
+}
+
+int AAdvPhysScene::GetSODMaxCellSpan() const
+{
+	return FMath::Clamp(SODHierarchyMaxCellSpan, 0, static_cast<int>(WORLD_CELL_LENGTH));
+}
+
+unsigned AAdvPhysScene::GetSODCoarseShift() const
+{
+	// Coarse cells of one fine cell would just duplicate the fine level
+	return FMath::Clamp(SODHierarchyCoarseShift, 1, WORLD_CELL_BITS - 1);
+}
+
+void AAdvPhysScene::CheckFromSODMap(const int FrameIndex, FSODWorkspace& Workspace) const
+{
+	const auto NumOfObjects = DynamicObjEntries.Num();
+	auto& ActMap = Workspace.ActivatorMap;
+	ActMap.clear();
+
+	// Small activators go to both levels to meet small and large objects alike, wide ones to the coarse level only,
+	// where RebuildSODMap then also puts the small objects
+	const int MaxCellSpan = GetSODMaxCellSpan();
+	const unsigned CoarseShift = GetSODCoarseShift();
+	for (int i = 0; i < Workspace.ActivatorBounds.Num(); i++)
+	{
+		uint64 StartHash, EndHash;
+		AdvPhysHashHelper::GetHash(Workspace.ActivatorBounds[i],
+			RecordData->HashWorldCenter, RecordData->HashCellSize,
+			StartHash, EndHash);
+		auto UpdateMap = [&ActMap, &i](uint64 Hash)
+		{
+			ActMap[Hash].push_back(i);
+		};
+		if (MaxCellSpan <= 0)
+		{
+			AdvPhysHashHelper::CubicSweepHash(StartHash, EndHash, UpdateMap);
+			continue;
+		}
+		AdvPhysHashHelper::CubicSweepHash(
+			AdvPhysHashHelper::ToCoarseHash(StartHash, CoarseShift),
+			AdvPhysHashHelper::ToCoarseHash(EndHash, CoarseShift),
+			UpdateMap);
+		if (AdvPhysHashHelper::GetMaxCellSpan(StartHash, EndHash) > static_cast<unsigned>(MaxCellSpan)) continue;
+		AdvPhysHashHelper::CubicSweepHash(StartHash, EndHash, UpdateMap);
+	}
+
+	// Single pass over cells occupied by both activators and objects
+	for (const auto& Cell : ActMap)
+	{
+		const auto FindIter = Workspace.SODMap.find(Cell.first);
+		if (FindIter == Workspace.SODMap.end()) continue;
+		for (const int ObjIndex : FindIter->second)
+		{
+			if (Workspace.ActivationState[ObjIndex]) continue;
+			const auto& Bounds = RecordData->ObjSOD[FrameIndex * NumOfObjects + ObjIndex].Bounds;
+			for (const int ActIndex : Cell.second)
+			{
+				if (!Workspace.ActivatorBounds[ActIndex].Intersect(Bounds)) continue;
+				Workspace.ActivationState[ObjIndex] = true;
+				Workspace.Activated.Add(ObjIndex);
+				break;
+			}
+		}
+	}
+}
+
+void AAdvPhysScene::SimulateObjectOnDemand(int ObjIndex, int FrameIndex)
+{
+	ADVPHYS_SCOPE_CYCLE(AdvPhysSODSimulateObject);
 	int StartFrameIndex = FrameIndex - 1;
 	int EndFrameIndex = FrameIndex;
 	if (StartFrameIndex < 0)
@@ -534,10 +1263,31 @@ void AAdvPhysScene::SimulateObjectOnDemand(int ObjIndex, int FrameIndex)
 		EndFrameIndex = 1;
 	}
 
-	const auto NumOfObjects = DynamicObjEntries.Num();
+	FPhysObjLocRot StartFrame, EndFrame;
+	GetPlayPose(ObjIndex, StartFrameIndex, StartFrame.Location, StartFrame.Rotation);
+	GetPlayPose(ObjIndex, EndFrameIndex, EndFrame.Location, EndFrame.Rotation);
+	ActivateObject(ObjIndex, StartFrame, EndFrame, FrameIndex);
+}
+
+// Radians per second turning From into To, along the shortest arc
+static FVector AngularVelocityBetween(const FRotator& From, const FRotator& To, float Interval)
+{
+	FQuat Delta = To.Quaternion() * From.Quaternion().Inverse();
+	Delta.EnforceShortestArcWith(FQuat::Identity);
+	FVector Axis;
+	double Angle;
+	Delta.ToAxisAndAngle(Axis, Angle);
+	return Axis * Angle / Interval;
+}
 
-	const auto& StartFrame = RecordData.ObjLocRot[StartFrameIndex * NumOfObjects + ObjIndex];
-	const auto& EndFrame = RecordData.ObjLocRot[EndFrameIndex * NumOfObjects + ObjIndex];
+void AAdvPhysScene::ActivateObject(int ObjIndex, const FPhysObjLocRot& StartFrame, const FPhysObjLocRot& EndFrame, int FrameIndex)
+{
+	Status.SODActivationState[ObjIndex] = true;
+	if (Status.OverrideSlots.Num() > 0)
+	{
+		Status.OverrideSlots[ObjIndex] = INDEX_NONE;
+	}
+	
 	const auto& Comp = DynamicObjEntries[ObjIndex].Comp;
 	
 	Comp->SetSimulatePhysics(true);
@@ -546,19 +1296,215 @@ void AAdvPhysScene::SimulateObjectOnDemand(int ObjIndex, int FrameIndex)
 	Comp->SetWorldLocationAndRotation(StartFrame.Location, StartFrame.Rotation, false, nullptr, ETeleportType::ResetPhysics);
 	Comp->SetWorldLocationAndRotation(EndFrame.Location, EndFrame.Rotation, true, nullptr, ETeleportType::ResetPhysics);
 
-	const auto LinearVel = (EndFrame.Location - StartFrame.Location) / RecordData.FrameInterval;
-	const auto AngularVel = (EndFrame.Rotation - StartFrame.Rotation).Euler() / RecordData.FrameInterval;
+	const auto LinearVel = (EndFrame.Location - StartFrame.Location) / RecordData->FrameInterval;
+	const auto AngularVel = AngularVelocityBetween(StartFrame.Rotation, EndFrame.Rotation, RecordData->FrameInterval);
 	Comp->SetPhysicsLinearVelocity(LinearVel);
-	Comp->SetPhysicsAngularVelocityInDegrees(AngularVel);
+	Comp->SetPhysicsAngularVelocityInRadians(AngularVel);
 	
 	if (bEnableSODChainReaction)
 	{
-		Status.AddedActivators.Add(Comp->GetAttachmentRoot());
+		AddActivator(Comp->GetAttachmentRoot());
+	}
+
+	if (bReplicateBakedPlayback && HasAuthority())
+	{
+		ReplicatedActivations.Add({ ObjIndex, FrameIndex });
 	}
 
 	if (Controller) Controller->DidStartSimulateOnDemand(this, ObjIndex, FrameIndex);
 }
 
+void AAdvPhysScene::ExpandToIslands(int FrameIndex, TArray<int>& Activated) const
+{
+	if (!bSODActivateIslands || Activated.Num() == 0 || RecordData->ObjIsland.Num() == 0) return;
+	
+	const auto NumOfObjects = DynamicObjEntries.Num();
+	const int* Islands = &RecordData->ObjIsland[FrameIndex * NumOfObjects];
+	TSet<int> Roots;
+	TBitArray<> IsActivated(false, NumOfObjects);
+	for (const int ObjIndex : Activated)
+	{
+		Roots.Add(Islands[ObjIndex]);
+		IsActivated[ObjIndex] = true;
+	}
+
+	// One pass picks up the rest of every island touched
+	for (int i = 0; i < NumOfObjects; i++)
+	{
+		if (IsActivated[i] || Status.SODActivationState[i] || !Roots.Contains(Islands[i])) continue;
+		Activated.Add(i);
+	}
+}
+
+void AAdvPhysScene::StartLocalRebake(int FrameIndex, const TArray<int>& Activated)
+{
+	if (!bSODLocalRebake || Activated.Num() == 0 || Status.bRebakePending || Rebaker.IsRecording()) return;
+	const float Interval = RecordData->FrameInterval;
+	const int FrameCount = FMath::Min(FMath::CeilToInt(LocalRebakeSeconds / Interval), RecordData->FrameCount - 1 - FrameIndex);
+	if (FrameCount < 2) return;
+
+	// Baked objects around the activated ones, found with the same kernel as naive SOD checks
+	const auto NumOfObjects = DynamicObjEntries.Num();
+	TArray<FBox> Regions;
+	FBox Region(ForceInit);
+	for (const int ObjIndex : Activated)
+	{
+		Regions.Add(RecordData->ObjSOD[FrameIndex * NumOfObjects + ObjIndex].Bounds.ExpandBy(LocalRebakeRadius));
+		Region += Regions.Last();
+	}
+	TArray<uint32> Mask;
+	const int Stride = RecordData->SODSoAStride;
+	AdvPhysSODKernel::OverlapActivators(&RecordData->ObjSODSoA[FrameIndex * SOD_SOA_PLANES * Stride], Stride, Regions, Mask);
+
+	auto& Objects = Status.RebakeObjects;
+	Objects.Reset();
+	for (int Word = 0; Word < Mask.Num(); Word++)
+	{
+		uint32 Bits = Mask[Word];
+		while (Bits && Objects.Num() < LocalRebakeMaxObjects)
+		{
+			const int i = Word * 32 + FMath::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+			if (i >= NumOfObjects || Status.SODActivationState[i]) continue;
+			Objects.Add(i);
+		}
+	}
+	if (Objects.Num() == 0) return;
+
+	// The scene is created once, every re-bake only swaps its bodies
+	if (Rebaker.IsInitialized())
+	{
+		Rebaker.ClearBodies();
+	}
+	else
+	{
+		Rebaker.SetProfile(GetBakeProfile());
+		Rebaker.Initialize();
+	}
+
+	// The re-bake runs in play space, from the poses objects are shown at now
+	const FBox PlayRegion = Status.bRelocated ? Region.TransformBy(Status.PlayTransform) : Region;
+	for (const auto& Obj : StaticObjEntries)
+	{
+		if (!Obj.Comp->Bounds.GetBox().Intersect(PlayRegion)) continue;
+		Rebaker.AddStaticBody(Obj.Comp, StaticObjShapeType);
+	}
+	for (const int ObjIndex : Objects)
+	{
+		Rebaker.AddDynamicBody(DynamicObjEntries[ObjIndex].Comp, bUseSimpleGeometryForDynamicObj);
+	}
+	for (const int ObjIndex : Activated)
+	{
+		Rebaker.AddDynamicBody(DynamicObjEntries[ObjIndex].Comp, bUseSimpleGeometryForDynamicObj);
+	}
+
+	for (int i = 0; i < Objects.Num(); i++)
+	{
+		FPhysObjLocRot Previous, Current;
+		GetPlayPose(Objects[i], FMath::Max(FrameIndex - 1, 0), Previous.Location, Previous.Rotation);
+		GetPlayPose(Objects[i], FrameIndex, Current.Location, Current.Rotation);
+		const auto Body = Rebaker.ObservedBodies[i];
+		Body->setLinearVelocity(U2PVector((Current.Location - Previous.Location) / Interval));
+		Body->setAngularVelocity(U2PVector(AngularVelocityBetween(Previous.Rotation, Current.Rotation, Interval)));
+	}
+	for (int i = 0; i < Activated.Num(); i++)
+	{
+		const auto& Comp = DynamicObjEntries[Activated[i]].Comp;
+		const auto Body = Rebaker.ObservedBodies[Objects.Num() + i];
+		Body->setLinearVelocity(U2PVector(Comp->GetPhysicsLinearVelocity()));
+		Body->setAngularVelocity(U2PVector(Comp->GetPhysicsAngularVelocityInRadians()));
+	}
+
+	RebakeData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	Rebaker.SetImpactRecording(false, 0.0f);
+	Rebaker.SetIslandRecording(false);
+	Rebaker.StartRecord(RebakeData.Get(), Interval, FrameCount, GetWorld()->GetGravityZ());
+	Status.bRebakePending = true;
+	Status.RebakeStartFrame = FrameIndex + 1;
+}
+
+void AAdvPhysScene::ApplyLocalRebake(int FrameIndex)
+{
+	if (!Status.bRebakePending || !RebakeData->Finished) return;
+	Status.bRebakePending = false;
+	
+	// Too slow to catch up with playback
+	if (FrameIndex >= Status.RebakeStartFrame + RebakeData->FrameCount - 1) return;
+
+	FTrackOverride Override;
+	Override.StartFrame = Status.RebakeStartFrame;
+	Override.FrameCount = RebakeData->FrameCount;
+	Override.ObjIndices = Status.RebakeObjects;
+	Override.Data = RebakeData;
+	const int Slot = Status.TrackOverrides.Add(MoveTemp(Override));
+
+	const auto NumOfObjects = DynamicObjEntries.Num();
+	if (Status.OverrideSlots.Num() != NumOfObjects)
+	{
+		Status.OverrideSlots.Init(INDEX_NONE, NumOfObjects);
+		Status.OverrideTracks.Init(INDEX_NONE, NumOfObjects);
+	}
+	// Objects join the new tracks at the frame being played, a later re-bake takes over from an earlier one
+	for (int i = 0; i < Status.RebakeObjects.Num(); i++)
+	{
+		const int ObjIndex = Status.RebakeObjects[i];
+		if (Status.SODActivationState[ObjIndex]) continue;
+		Status.OverrideSlots[ObjIndex] = Slot;
+		Status.OverrideTracks[ObjIndex] = i;
+	}
+}
+
+void AAdvPhysScene::RetireTrackOverrides(int FrameIndex)
+{
+	for (auto It = Status.TrackOverrides.CreateIterator(); It; ++It)
+	{
+		const auto& Override = *It;
+		const int LastFrame = Override.StartFrame + Override.FrameCount - 1;
+		if (FrameIndex < LastFrame) continue;
+
+		const int Slot = It.GetIndex();
+		const int Count = Override.Data->ObjectCount;
+		for (int i = 0; i < Override.ObjIndices.Num(); i++)
+		{
+			const int ObjIndex = Override.ObjIndices[i];
+			if (Status.OverrideSlots[ObjIndex] != Slot) continue;
+			Status.OverrideSlots[ObjIndex] = INDEX_NONE;
+
+			// Objects that ended up away from their bake keep moving from where the re-bake left them
+			const auto& Previous = Override.Data->ObjLocRot[(Override.FrameCount - 2) * Count + i];
+			const auto& Current = Override.Data->ObjLocRot[(Override.FrameCount - 1) * Count + i];
+			FVector BakedLocation;
+			FRotator BakedRotation;
+			GetPlayPose(ObjIndex, FMath::Min(LastFrame, RecordData->FrameCount - 1), BakedLocation, BakedRotation);
+			if (FVector::Dist(BakedLocation, Current.Location) <= LocalRebakeReturnTolerance) continue;
+			ActivateObject(ObjIndex, Previous, Current, FrameIndex);
+		}
+		It.RemoveCurrent();
+	}
+}
+
+void AAdvPhysScene::StopLocalRebake()
+{
+	Rebaker.StopRecordAndWait();
+	if (Rebaker.IsInitialized())
+	{
+		Rebaker.Cleanup();
+	}
+	Status.bRebakePending = false;
+}
+
+void AAdvPhysScene::AddActivator(USceneComponent* Comp)
+{
+	if (Status.AddedActivatorSet.Contains(Comp)) return;
+	if (SODMaxAddedActivators > 0 && Status.AddedActivators.Num() >= SODMaxAddedActivators)
+	{
+		Status.AddedActivatorSet.Remove(Status.AddedActivators[0].Comp);
+		Status.AddedActivators.RemoveAt(0);
+	}
+	Status.AddedActivatorSet.Add(Comp);
+	Status.AddedActivators.Add({ Comp, GetWorld()->GetTimeSeconds() });
+}
+
 void AAdvPhysScene::AddTaggedObjects()
 {
 	int NumOfDynActors = 0, NumOfStaticActors = 0, NumOfDynComps = 0, NumOfStaticComps = 0, NumOfActivators = 0, NumOfGeom = 0;
@@ -566,7 +1512,7 @@ void AAdvPhysScene::AddTaggedObjects()
 	
 	TArray<AActor*> Actors;
 	TArray<UStaticMeshComponent*> Comps;
-	UGameplayStatics::GetAllActorsWithTag(GetWorld(), DynamicTag, Actors);
+	if (!DynamicTag.IsNone()) UGameplayStatics::GetAllActorsWithTag(GetWorld(), DynamicTag, Actors);
 	for (const auto& Actor : Actors)
 	{
 		NumOfDynActors++;
@@ -581,7 +1527,7 @@ void AAdvPhysScene::AddTaggedObjects()
 	}
 		
 	Actors.Empty();
-	UGameplayStatics::GetAllActorsWithTag(GetWorld(), StaticTag, Actors);
+	if (!StaticTag.IsNone()) UGameplayStatics::GetAllActorsWithTag(GetWorld(), StaticTag, Actors);
 	for (const auto& Actor : Actors)
 	{
 		NumOfStaticActors++;
@@ -595,7 +1541,7 @@ void AAdvPhysScene::AddTaggedObjects()
 	}
 
 	Actors.Empty();
-	UGameplayStatics::GetAllActorsWithTag(GetWorld(), ActivatorTag, Actors);
+	if (!ActivatorTag.IsNone()) UGameplayStatics::GetAllActorsWithTag(GetWorld(), ActivatorTag, Actors);
 	for (const auto& Actor : Actors)
 	{
 		NumOfActivators++;
@@ -629,15 +1575,16 @@ void AAdvPhysScene::Tick(float DeltaTime)
 		DoRecordTick();
 		break;
 	case Playing:
-		DoPlayTick();
+		DoPlayTick(DeltaTime);
 		break;
 	case PlayingRealtimeSimulation:
 		DoPlayRealtimeSimulationTick();
 		break;
 	default:;
 	}
+	UpdateBakeBytesStat();
 
-	if (Status.Current == Playing && RecordData.bEnableSOD)
+	if (Status.Current == Playing && RecordData->bEnableSOD)
 	{
 		if (bDrawSODObjectBoundsOnPlay)
 			DrawSODObjectBounds();
@@ -646,6 +1593,8 @@ void AAdvPhysScene::Tick(float DeltaTime)
 		if (bDrawSODActivatedObjectsOnPlay)
 			DrawSODActivatedObjects();
 	}
+	if (Status.Current == Playing && bDrawTelemetryGraphOnPlay)
+		DrawTelemetryGraph();
 }
 
 void AAdvPhysScene::BeginPlay()
@@ -653,21 +1602,486 @@ void AAdvPhysScene::BeginPlay()
 	Super::BeginPlay();
 	Simulator.Initialize();
 
+	if (bReplicateBakedPlayback && HasAuthority())
+	{
+		SetReplicates(true);
+	}
+
+	// Re-baked tracks are not replicated, clients would drift apart from the server
+	if (bReplicateBakedPlayback && bSODLocalRebake)
+	{
+		FMessageLog("AdvPhysScene").Warning(FText::FromString("Local re-bake is disabled because baked playback is replicated"));
+		bSODLocalRebake = false;
+	}
+
+	TArray<UStaticMeshComponent*> Comps;
+	for (const auto& Actor : DynamicActors)
+	{
+		if (!Actor) continue;
+		Comps.Empty();
+		Actor->GetComponents<UStaticMeshComponent>(Comps);
+		for (const auto& Comp : Comps)
+		{
+			AddDynamicObj(Comp);
+		}
+	}
+
 	if (bAddTaggedObjectsOnBeginPlay)
 	{
 		AddTaggedObjects();
 	}
+
+	if (!PlaybackGroup.IsNone())
+	{
+		GetWorld()->GetSubsystem<UAdvPhysStreamingSubsystem>()->GroupStarted.AddUObject(this, &AAdvPhysScene::OnPlaybackGroupStarted);
+	}
+
+	if (EmbeddedBake)
+	{
+		ReadBakeAsset(EmbeddedBake);
+	}
+	else if (!BakeAsset.IsNull())
+	{
+		LoadBakeAsset();
+	}
+}
+
+void AAdvPhysScene::LoadBakeAsset()
+{
+	TWeakObjectPtr<AAdvPhysScene> WeakThis(this);
+	UAssetManager::GetStreamableManager().RequestAsyncLoad(BakeAsset.ToSoftObjectPath(), [WeakThis]()
+	{
+		if (!WeakThis.IsValid()) return;
+		UAdvPhysBakeAsset* Asset = WeakThis->BakeAsset.Get();
+		if (!Asset)
+		{
+			FMessageLog("AdvPhysScene").Error(FText::FromString("Failed to load bake asset."));
+			return;
+		}
+		WeakThis->ReadBakeAsset(Asset);
+	});
+}
+
+void AAdvPhysScene::ReadBakeAsset(UAdvPhysBakeAsset* Asset)
+{
+	// The payload is read from bulk data off the game thread, then handed back
+	Async(EAsyncExecution::ThreadPool, [WeakThis = TWeakObjectPtr<AAdvPhysScene>(this), WeakAsset = TWeakObjectPtr<UAdvPhysBakeAsset>(Asset)]()
+	{
+		if (!WeakAsset.IsValid()) return;
+		FPhysRecordDataPtr Data = WeakAsset->LoadRecordData();
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Data]()
+		{
+			if (!WeakThis.IsValid() || !Data) return;
+			WeakThis->SetBakeData(Data);
+		});
+	});
+}
+
+void AAdvPhysScene::SetBakeData(FPhysRecordDataPtr Data)
+{
+	CancelInternal();
+	if (!BindObjectsToBake(*Data)) return;
+	RecordData = Data;
+	EventTimeline.Reset();
+	bBakeEvicted = false;
+	bBakeReloading = false;
+	BakeLoaded.Broadcast();
+
+	// Cells streaming in mid-playback catch up with the rest of their group
+	const bool bPlay = bPlayOnBakeReload || GetWorld()->GetSubsystem<UAdvPhysStreamingSubsystem>()->IsGroupPlaying(PlaybackGroup);
+	bPlayOnBakeReload = false;
+	if (bPlay)
+	{
+		Play();
+	}
+	// Replicas loading their bake late join the server's playback
+	if (IsPlaybackReplica() && ReplicatedPlayback.bPlaying)
+	{
+		OnRep_Playback();
+	}
+	GetWorld()->GetSubsystem<UAdvPhysBakeCacheSubsystem>()->NotifyBakeResident(this);
+}
+
+bool AAdvPhysScene::BindObjectsToBake(const FPhysRecordData& Data)
+{
+	if (Data.ObjectIds.Num() == 0) return true;
+
+	// Reorder entries to match the bake so indices into it stay valid
+	TMap<FName, int> EntryIndices;
+	EntryIndices.Reserve(DynamicObjEntries.Num());
+	for (int i = 0; i < DynamicObjEntries.Num(); i++)
+	{
+		EntryIndices.Add(DynamicObjEntries[i].Id, i);
+	}
+
+	TArray<FPhysObject> Bound;
+	Bound.Reserve(Data.ObjectIds.Num());
+	for (const auto& Id : Data.ObjectIds)
+	{
+		int Index;
+		if (!EntryIndices.RemoveAndCopyValue(Id, Index))
+		{
+			FMessageLog("AdvPhysScene").Error(
+				FText::Format(
+					FText::FromString("Bake object {0} is not a dynamic object of this scene."),
+					FText::FromName(Id)
+				)
+			);
+			return false;
+		}
+		Bound.Add(DynamicObjEntries[Index]);
+	}
+
+	// Whatever is left was never baked and will not move on playback
+	for (const auto& Pair : EntryIndices)
+	{
+		FMessageLog("AdvPhysScene").Warning(
+			FText::Format(
+				FText::FromString("Dynamic object {0} is not in the bake and will stay in place."),
+				FText::FromName(Pair.Key)
+			)
+		);
+	}
+
+	DynamicObjEntries = MoveTemp(Bound);
+	DynamicObjIndices.Empty();
+	for (int i = 0; i < DynamicObjEntries.Num(); i++)
+	{
+		DynamicObjIndices.Add(DynamicObjEntries[i].Comp, i);
+	}
+	return true;
+}
+
+void AAdvPhysScene::OnBakeSourceLoaded()
+{
+	BakeSource->BakeLoaded.RemoveAll(this);
+	if (!bPlayOnBakeReload) return;
+	bPlayOnBakeReload = false;
+	Play();
+}
+
+void AAdvPhysScene::OnPlaybackGroupStarted(FName Group)
+{
+	if (Group != PlaybackGroup || Status.Current != Idle || !RecordData->Finished) return;
+	Play();
+}
+
+void AAdvPhysScene::SaveBakeToAsset(UAdvPhysBakeAsset* Asset)
+{
+	if (!Asset)
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString("SaveBakeToAsset invalid argument"));
+		return;
+	}
+	Asset->SetRecordData(*RecordData);
+}
+
+#if WITH_EDITOR
+static FPhysRecordDataPtr ExtractBakeSubset(const FPhysRecordData& Data, const TArray<int>& ObjIndices, const FTransform& Origin)
+{
+	const int NumOfObjects = Data.ObjectCount;
+	const int NumOfSubObjects = ObjIndices.Num();
+	
+	auto Sub = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	Sub->Finished = true;
+	Sub->Progress = 1.0f;
+	Sub->FrameCount = Data.FrameCount;
+	Sub->FrameInterval = Data.FrameInterval;
+	Sub->ObjectCount = NumOfSubObjects;
+	Sub->bEnableSOD = Data.bEnableSOD;
+	Sub->Origin = Origin;
+	Sub->HashWorldCenter = Data.HashWorldCenter;
+	Sub->HashCellSize = Data.HashCellSize;
+	for (const int ObjIndex : ObjIndices)
+	{
+		Sub->ObjectIds.Add(Data.ObjectIds[ObjIndex]);
+	}
+
+	Sub->ObjLocRot.Reserve(Data.FrameCount * NumOfSubObjects);
+	for (int i = 0; i < Data.FrameCount; i++)
+	{
+		for (const int ObjIndex : ObjIndices)
+		{
+			Sub->ObjLocRot.Add(Data.ObjLocRot[i * NumOfObjects + ObjIndex]);
+		}
+	}
+	Sub->UpdateChecksum();
+	if (Data.HasImpacts())
+	{
+		// Impacts go to the scene holding the first object of the pair, objects of other cells count as static
+		TMap<int, int> SubIndices;
+		for (int j = 0; j < NumOfSubObjects; j++)
+		{
+			SubIndices.Add(ObjIndices[j], j);
+		}
+		Sub->ImpactFrameStarts.Reserve(Data.FrameCount + 1);
+		Sub->ImpactFrameStarts.Add(0);
+		for (int i = 0; i < Data.FrameCount; i++)
+		{
+			for (int j = Data.ImpactFrameStarts[i]; j < Data.ImpactFrameStarts[i + 1]; j++)
+			{
+				FPhysImpactEvent Impact = Data.Impacts[j];
+				const int First = Impact.ObjA == INDEX_NONE ? Impact.ObjB : Impact.ObjA;
+				if (!SubIndices.Contains(First)) continue;
+				const int* SubA = SubIndices.Find(Impact.ObjA);
+				const int* SubB = SubIndices.Find(Impact.ObjB);
+				Impact.ObjA = SubA ? *SubA : INDEX_NONE;
+				Impact.ObjB = SubB ? *SubB : INDEX_NONE;
+				Sub->Impacts.Add(Impact);
+			}
+			Sub->ImpactFrameStarts.Add(Sub->Impacts.Num());
+		}
+	}
+	if (Data.ObjIsland.Num() > 0)
+	{
+		// Islands are renamed to their lowest object in the subset, members in other cells are dropped
+		TMap<int, int> SubRoots;
+		Sub->ObjIsland.Reserve(Data.FrameCount * NumOfSubObjects);
+		for (int i = 0; i < Data.FrameCount; i++)
+		{
+			SubRoots.Reset();
+			for (int j = 0; j < NumOfSubObjects; j++)
+			{
+				Sub->ObjIsland.Add(SubRoots.FindOrAdd(Data.ObjIsland[i * NumOfObjects + ObjIndices[j]], j));
+			}
+		}
+	}
+	if (!Data.bEnableSOD) return Sub;
+
+	// Hashes stay valid as the hash grid is kept, only the SoA layout depends on the object count
+	const int Stride = AdvPhysSODKernel::GetStride(NumOfSubObjects);
+	Sub->SODSoAStride = Stride;
+	Sub->ObjSOD.Reserve(Data.FrameCount * NumOfSubObjects);
+	Sub->ObjSODSoA.AddZeroed(Data.FrameCount * SOD_SOA_PLANES * Stride);
+	for (int i = 0; i < Data.FrameCount; i++)
+	{
+		float* FrameSoA = &Sub->ObjSODSoA[i * SOD_SOA_PLANES * Stride];
+		AdvPhysSODKernel::ResetPadding(FrameSoA, NumOfSubObjects, Stride);
+		for (int j = 0; j < NumOfSubObjects; j++)
+		{
+			const auto& SODData = Data.ObjSOD[i * NumOfObjects + ObjIndices[j]];
+			Sub->ObjSOD.Add(SODData);
+			AdvPhysSODKernel::WriteBounds(FrameSoA, Stride, j, SODData.Bounds.Min, SODData.Bounds.Max);
+		}
+	}
+	return Sub;
+}
+
+void AAdvPhysScene::PartitionBakeByCell()
+{
+	UAdvPhysBakeAsset* Asset = BakeAsset.LoadSynchronous();
+	const FPhysRecordDataPtr Data = Asset ? Asset->LoadRecordData() : nullptr;
+	if (!Data || PartitionCellSize <= 0)
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString("PartitionBakeByCell needs a bake asset and a positive cell size."));
+		return;
+	}
+
+	// Bake ids resolve to the components placed in the level
+	TMap<FName, UStaticMeshComponent*> Components;
+	TArray<UStaticMeshComponent*> Comps;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		Comps.Empty();
+		It->GetComponents<UStaticMeshComponent>(Comps);
+		for (const auto& Comp : Comps)
+		{
+			Components.Add(FPhysObject::GetStableId(Comp), Comp);
+		}
+	}
+
+	// Actors go to the cell of their location as a whole so none is split between two scenes.
+	// Cells are 2D like the World Partition runtime grid.
+	TMap<FIntPoint, TArray<int>> CellObjects;
+	TMap<FIntPoint, TSet<AActor*>> CellActors;
+	for (int i = 0; i < Data->ObjectIds.Num(); i++)
+	{
+		const auto Comp = Components.FindRef(Data->ObjectIds[i]);
+		if (!Comp)
+		{
+			FMessageLog("AdvPhysScene").Error(
+				FText::Format(
+					FText::FromString("Bake object {0} is not in the level."),
+					FText::FromName(Data->ObjectIds[i])
+				)
+			);
+			return;
+		}
+		const FVector Location = Comp->GetOwner()->GetActorLocation();
+		const FIntPoint Cell(FMath::FloorToInt(Location.X / PartitionCellSize), FMath::FloorToInt(Location.Y / PartitionCellSize));
+		CellObjects.FindOrAdd(Cell).Add(i);
+		CellActors.FindOrAdd(Cell).Add(Comp->GetOwner());
+	}
+
+	// Cell scenes keep playing the bake where this scene would
+	const FTransform PlayTransform = Data->Origin.Inverse() * FTransform(GetActorRotation(), GetActorLocation());
+	const FName Group = PlaybackGroup.IsNone() ? GetFName() : PlaybackGroup;
+	
+	FActorSpawnParameters Params;
+	Params.Template = this;
+	for (const auto& Cell : CellObjects)
+	{
+		const FVector Center((Cell.Key.X + 0.5f) * PartitionCellSize, (Cell.Key.Y + 0.5f) * PartitionCellSize, GetActorLocation().Z);
+		const FTransform CellTransform(Center);
+		const auto Scene = GetWorld()->SpawnActor<AAdvPhysScene>(GetClass(), CellTransform, Params);
+		if (!Scene) continue;
+		
+		Scene->SetActorLabel(FString::Printf(TEXT("%s_Cell_%d_%d"), *GetActorLabel(), Cell.Key.X, Cell.Key.Y));
+		Scene->PlaybackGroup = Group;
+		Scene->BakeAsset.Reset();
+		Scene->BakeSource = nullptr;
+		// Controllers and the objects of other cells are referenced from here only, so they would be pulled into every cell
+		Scene->Controller = nullptr;
+		Scene->DynamicTag = NAME_None;
+		Scene->StaticTag = NAME_None;
+		Scene->DynamicActors = CellActors[Cell.Key].Array();
+		Scene->EventActors.Reset();
+		for (const auto& Event : EventActors)
+		{
+			if (!Event) continue;
+			const FVector Location = Event->GetActorLocation();
+			if (FIntPoint(FMath::FloorToInt(Location.X / PartitionCellSize), FMath::FloorToInt(Location.Y / PartitionCellSize)) != Cell.Key) continue;
+			Scene->EventActors.Add(Event);
+		}
+		
+		Scene->EmbeddedBake = NewObject<UAdvPhysBakeAsset>(Scene);
+		Scene->EmbeddedBake->SetRecordData(*ExtractBakeSubset(*Data, Cell.Value, CellTransform * PlayTransform.Inverse()));
+	}
+
+	FMessageLog("AdvPhysScene").Info(
+		FText::Format(
+			FText::FromString("Partitioned {0} objects into {1} cell scenes of group {2}, this scene can be removed."),
+			Data->ObjectCount,
+			CellObjects.Num(),
+			FText::FromName(Group)
+		)
+	);
+}
+#endif
+
+#if WITH_EDITOR
+void AAdvPhysScene::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(AAdvPhysScene, EventActors))
+	{
+		EventTimeline.Reset();
+	}
+}
+#endif
+
+void AAdvPhysScene::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(AAdvPhysScene, ReplicatedPlayback);
+	DOREPLIFETIME(AAdvPhysScene, ReplicatedActivations);
+}
+
+bool AAdvPhysScene::IsPlaybackReplica() const
+{
+	return bReplicateBakedPlayback && !HasAuthority();
+}
+
+uint32 AAdvPhysScene::GetBakeChecksum() const
+{
+	return RecordData->Checksum;
+}
+
+double AAdvPhysScene::GetServerTime() const
+{
+	const auto GameState = GetWorld()->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+float AAdvPhysScene::GetReplicatedPlayTime() const
+{
+	const auto& Rep = ReplicatedPlayback;
+	return FMath::Max(0.0f, Rep.AnchorPlayTime + static_cast<float>(GetServerTime() - Rep.AnchorServerTime) * Rep.Rate);
+}
+
+void AAdvPhysScene::UpdateReplicatedPlayback(bool bRestart)
+{
+	if (!bReplicateBakedPlayback || !HasAuthority()) return;
+	
+	auto& Rep = ReplicatedPlayback;
+	Rep.bPlaying = Status.Current == Playing;
+	Rep.AnchorServerTime = GetServerTime();
+	Rep.AnchorPlayTime = Status.PlayTime;
+	Rep.Rate = PlaybackRate;
+	if (bRestart)
+	{
+		// Activations of the previous playback were undone by restarting or seeking
+		Rep.BakeChecksum = GetBakeChecksum();
+		Rep.PlayCount++;
+		ReplicatedActivations.Reset();
+	}
+}
+
+void AAdvPhysScene::OnRep_Playback()
+{
+	const auto& Rep = ReplicatedPlayback;
+	if (!Rep.bPlaying)
+	{
+		if (Status.Current == Playing) Cancel();
+		return;
+	}
+	
+	PlaybackRate = Rep.Rate;
+	if (Status.Current == Playing && AppliedPlayCount == Rep.PlayCount) return;
+	
+	// Bakes still loading join once they are set
+	if (Status.Current != Playing) Play();
+	if (Status.Current != Playing) return;
+	if (GetBakeChecksum() != Rep.BakeChecksum)
+	{
+		FMessageLog("AdvPhysScene").Error(FText::FromString("Server plays a different bake than this client has, replicated playback stopped."));
+		CancelInternal();
+		return;
+	}
+	
+	AppliedPlayCount = Rep.PlayCount;
+	Seek(GetReplicatedPlayTime());
+	Status.ReplicatedActivationCursor = 0;
+	OnRep_Activations();
+}
+
+void AAdvPhysScene::OnRep_Activations()
+{
+	if (Status.Current != Playing || !RecordData->bEnableSOD || AppliedPlayCount != ReplicatedPlayback.PlayCount) return;
+	
+	for (; Status.ReplicatedActivationCursor < ReplicatedActivations.Num(); Status.ReplicatedActivationCursor++)
+	{
+		const auto& Activation = ReplicatedActivations[Status.ReplicatedActivationCursor];
+		if (!Status.SODActivationState.IsValidIndex(Activation.ObjIndex) || Status.SODActivationState[Activation.ObjIndex]) continue;
+		SimulateObjectOnDemand(Activation.ObjIndex, FMath::Clamp(Activation.Frame, 0, RecordData->FrameCount - 1));
+	}
 }
 
 void AAdvPhysScene::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
+	WaitForSODTask();
+	WorkerClient.Stop();
+	// The record thread writes into RecordData through a raw pointer until it exits
+	Simulator.StopRecordAndWait();
 	Simulator.Cleanup();
+
+	StopLocalRebake();
+	GetWorld()->GetSubsystem<UAdvPhysStreamingSubsystem>()->GroupStarted.RemoveAll(this);
+	if (BakeSource && BakeSource != this) BakeSource->BakeLoaded.RemoveAll(this);
+	GetWorld()->GetSubsystem<UAdvPhysBakeCacheSubsystem>()->Remove(this);
+	DeleteBakeSpill();
+
+	// Streaming out drops this scene's reference to the bake right away, instances may still hold it
+	Status = {};
+	RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+	EventTimeline.Reset();
+	UpdateBakeBytesStat();
 }
 
 void AAdvPhysScene::DoRecordTick()
 {
-	if (RecordData.Finished)
+	if (RecordData->Finished)
 	{
 		const double Now = FPlatformTime::Seconds();
 		FMessageLog("AdvPhysScene").Info(FText::Format(
@@ -678,14 +2092,50 @@ void AAdvPhysScene::DoRecordTick()
 		Simulator.ClearScene();
 		Simulator.FreeEvents();
 		RecordFinished.Broadcast();
+		GetWorld()->GetSubsystem<UAdvPhysBakeCacheSubsystem>()->NotifyBakeResident(this);
+	}
+	else if (Status.bRecordingInWorker && !WorkerClient.IsRunning())
+	{
+		FMessageLog("AdvPhysScene").Error(FText::Format(
+			FText::FromString("Bake worker failed: {0}"),
+			FText::FromString(WorkerClient.GetError())
+			));
+		Status = {};
+		RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
 	}
 }
 
-void AAdvPhysScene::DoPlayTick()
+void AAdvPhysScene::DoPlayTick(float DeltaTime)
 {
+	ADVPHYS_SCOPE_CYCLE(AdvPhysPlayTick);
 	const float Now = GetWorld()->GetTimeSeconds();
-	const float CurrentTime = Now - Status.PlayStartTime;
-	if (RecordData.bEnableSOD && bEnableSOD && (SODCheckFramesPerSecond <= 0 || Now - Status.LastSODCheckTime >= 1.0f / SODCheckFramesPerSecond))
+	const float PreviousTime = Status.PlayTime;
+	// Replicas follow the server's clock and cells their group's rather than accumulating their own frame times
+	float GroupTime;
+	if (IsPlaybackReplica())
+		Status.PlayTime = GetReplicatedPlayTime();
+	else if (!PlaybackGroup.IsNone() && GetWorld()->GetSubsystem<UAdvPhysStreamingSubsystem>()->GetGroupPlayTime(PlaybackGroup, GroupTime))
+		Status.PlayTime = GroupTime;
+	else
+		Status.PlayTime = FMath::Max(0.0f, Status.PlayTime + DeltaTime * PlaybackRate);
+	const float CurrentTime = Status.PlayTime;
+
+	// Rewinding un-triggers events so they fire again when playing forward past them
+	if (CurrentTime < PreviousTime)
+	{
+		Status.EventCursor = EventTimeline->Seek(CurrentTime);
+		Status.ImpactFrameCursor = FMath::CeilToInt(CurrentTime / RecordData->FrameInterval);
+	}
+	
+	if (RecordData->bEnableSOD)
+	{
+		const int FrameIndex = FMath::Min(FMath::FloorToInt(CurrentTime / RecordData->FrameInterval), RecordData->FrameCount - 1);
+		ApplyAsyncSODResult(FrameIndex);
+		ApplyLocalRebake(FrameIndex);
+		RetireTrackOverrides(FrameIndex);
+	}
+	// Activated objects can only be simulated forward
+	if (RecordData->bEnableSOD && bEnableSOD && PlaybackRate > 0 && !IsPlaybackReplica() && (SODCheckFramesPerSecond <= 0 || Now - Status.LastSODCheckTime >= 1.0f / SODCheckFramesPerSecond))
 	{
 		CheckSODAtTime(CurrentTime);
 		Status.LastSODCheckTime = Now;
@@ -695,15 +2145,46 @@ void AAdvPhysScene::DoPlayTick()
 	{
 		PlayFrame(CurrentTime);
 		HandleEventsInFrame(CurrentTime, false);
+		DispatchImpacts(CurrentTime);
 		Status.LastPlayFrameTime = Now;
 		if (CurrentTime > GetDuration())
 		{
 			FMessageLog("AdvPhysScene").Info(FText::FromString("Playing finished."));
+			WaitForSODTask();
+			StopPlaybackGroup();
 			Status = {};
+			UpdateReplicatedPlayback(false);
+			// Instances let go of the shared bake so its source can be evicted
+			if (BakeSource && BakeSource != this)
+			{
+				RecordData = MakeShared<FPhysRecordData, ESPMode::ThreadSafe>();
+			}
 		}
 	}
 }
 
+FPhysBakeProfile AAdvPhysScene::GetBakeProfile() const
+{
+	return BakeProfile ? BakeProfile->Profile : FPhysBakeProfile();
+}
+
+void AAdvPhysScene::UpdateBakeBytesStat()
+{
+	// Shared bakes count once, towards their source
+	const bool bIsInstance = BakeSource && BakeSource != this;
+	const SIZE_T BakeBytes = bIsInstance ? 0 : (RecordData->Finished ? RecordData->GetAllocatedSize() : 0) + GetBakePayloadSize();
+	if (BakeBytes == StatBakeBytes) return;
+	if (BakeBytes > StatBakeBytes)
+	{
+		ADVPHYS_MEMORY_ADD(AdvPhysBakeBytes, BakeBytes - StatBakeBytes);
+	}
+	else
+	{
+		ADVPHYS_MEMORY_SUBTRACT(AdvPhysBakeBytes, StatBakeBytes - BakeBytes);
+	}
+	StatBakeBytes = BakeBytes;
+}
+
 void AAdvPhysScene::DoPlayRealtimeSimulationTick()
 {
 	const float Now = GetWorld()->GetTimeSeconds();
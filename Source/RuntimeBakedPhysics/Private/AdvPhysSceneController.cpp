@@ -38,6 +38,10 @@ void AAdvPhysSceneController::DidStartSimulateOnDemand(AAdvPhysScene* Scene, int
 {
 }
 
+void AAdvPhysSceneController::DidPlayImpact(AAdvPhysScene* Scene, const FPhysImpactEvent& Impact)
+{
+}
+
 // Called every frame
 void AAdvPhysSceneController::Tick(float DeltaTime)
 {
@@ -0,0 +1,220 @@
+#include "AdvPhysSceneFile.h"
+
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#define SCENE_FILE_VERSION 2
+
+static void SerializeString(FArchive& Ar, FString& Value)
+{
+	if (Ar.IsLoading())
+	{
+		uint32 Length = 0;
+		Ar << Length;
+		if (Ar.IsError() || Length > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return;
+		}
+		TArray<ANSICHAR> Bytes;
+		Bytes.SetNumUninitialized(Length);
+		Ar.Serialize(Bytes.GetData(), Length);
+		const FUTF8ToTCHAR Converted(Bytes.GetData(), Length);
+		Value = FString(Converted.Length(), Converted.Get());
+		return;
+	}
+	FTCHARToUTF8 Utf8(*Value);
+	uint32 Length = Utf8.Length();
+	Ar << Length;
+	Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Length);
+}
+
+static void SerializeVector(FArchive& Ar, FVector3f& Value)
+{
+	Ar << Value.X << Value.Y << Value.Z;
+}
+
+static void SerializeTransform(FArchive& Ar, FTransform& Value)
+{
+	FVector3f Position(Value.GetLocation());
+	FQuat4f Rotation(Value.GetRotation());
+	SerializeVector(Ar, Position);
+	Ar << Rotation.X << Rotation.Y << Rotation.Z << Rotation.W;
+	if (Ar.IsLoading())
+	{
+		Value = FTransform(FQuat(Rotation), FVector(Position));
+	}
+}
+
+// Element counts are checked against what is left of the file before anything is allocated for them
+static bool SerializeCount(FArchive& Ar, int32 Num, int32& OutNum, int32 MinElementSize)
+{
+	uint32 Count = Num;
+	Ar << Count;
+	OutNum = Count;
+	if (Ar.IsLoading() && (Ar.IsError() || static_cast<int64>(Count) * MinElementSize > Ar.TotalSize() - Ar.Tell()))
+	{
+		Ar.SetError();
+		return false;
+	}
+	return true;
+}
+
+static void SerializeFlag(FArchive& Ar, bool& Value)
+{
+	uint8 Byte = Value;
+	Ar << Byte;
+	Value = Byte != 0;
+}
+
+// PVD settings stay behind, the tool has no debugger connection
+static void SerializeProfile(FArchive& Ar, FPhysBakeProfile& Profile)
+{
+	uint8 Broadphase = Profile.Broadphase;
+	Ar << Broadphase;
+	Profile.Broadphase = static_cast<EPhysBroadphaseType>(Broadphase);
+	Ar << Profile.WorldBounds.Min.X << Profile.WorldBounds.Min.Y << Profile.WorldBounds.Min.Z;
+	Ar << Profile.WorldBounds.Max.X << Profile.WorldBounds.Max.Y << Profile.WorldBounds.Max.Z;
+	Profile.WorldBounds.IsValid = 1;
+	Ar << Profile.MBPSubdivisions;
+	SerializeFlag(Ar, Profile.bEnablePCM);
+	SerializeFlag(Ar, Profile.bEnableStabilization);
+	SerializeFlag(Ar, Profile.bEnableCCD);
+	Ar << Profile.PositionIterations << Profile.VelocityIterations << Profile.SleepThreshold;
+}
+
+static void SerializeShape(FArchive& Ar, FPhysShapeDesc& Shape)
+{
+	uint8 Type = static_cast<uint8>(Shape.Type);
+	Ar << Type;
+	Shape.Type = static_cast<EPhysShapeDescType>(Type);
+	SerializeVector(Ar, Shape.Params);
+	SerializeTransform(Ar, Shape.LocalPose);
+	SerializeVector(Ar, Shape.Scale);
+	Ar << Shape.StaticFriction << Shape.DynamicFriction << Shape.Restitution;
+
+	int32 Num;
+	if (!SerializeCount(Ar, Shape.Vertices.Num(), Num, sizeof(FVector3f))) return;
+	if (Ar.IsLoading()) Shape.Vertices.SetNumUninitialized(Num);
+	Ar.Serialize(Shape.Vertices.GetData(), Num * sizeof(FVector3f));
+
+	if (!SerializeCount(Ar, Shape.Indices.Num(), Num, sizeof(uint32))) return;
+	if (Ar.IsLoading()) Shape.Indices.SetNumUninitialized(Num);
+	Ar.Serialize(Shape.Indices.GetData(), Num * sizeof(uint32));
+}
+
+static void SerializeBody(FArchive& Ar, FPhysBodyDesc& Body)
+{
+	uint8 bDynamic = Body.bDynamic;
+	Ar << bDynamic;
+	Body.bDynamic = bDynamic != 0;
+	SerializeTransform(Ar, Body.Pose);
+	Ar << Body.Mass;
+	SerializeVector(Ar, Body.LinearVelocity);
+	SerializeVector(Ar, Body.AngularVelocity);
+
+	int32 Num;
+	if (!SerializeCount(Ar, Body.Shapes.Num(), Num, 1)) return;
+	if (Ar.IsLoading()) Body.Shapes.SetNum(Num);
+	for (auto& Shape : Body.Shapes)
+	{
+		SerializeShape(Ar, Shape);
+		if (Ar.IsError()) return;
+	}
+}
+
+static void SerializeEvent(FArchive& Ar, FPhysEventDesc& Event)
+{
+	SerializeString(Ar, Event.Class);
+	SerializeTransform(Ar, Event.Transform);
+
+	int32 Num;
+	if (!SerializeCount(Ar, Event.PropertyNames.Num(), Num, 2 * sizeof(uint32))) return;
+	if (Ar.IsLoading())
+	{
+		Event.PropertyNames.SetNum(Num);
+		Event.PropertyValues.SetNum(Num);
+	}
+	for (int i = 0; i < Num; i++)
+	{
+		SerializeString(Ar, Event.PropertyNames[i]);
+		SerializeString(Ar, Event.PropertyValues[i]);
+	}
+}
+
+void AdvPhysSceneFile::Serialize(FArchive& Ar, FPhysSceneDesc& Desc)
+{
+	uint8 Magic[4] = { 'A', 'P', 'S', 'F' };
+	uint32 Version = SCENE_FILE_VERSION;
+	Ar.Serialize(Magic, sizeof(Magic));
+	Ar << Version;
+	if (FMemory::Memcmp(Magic, "APSF", sizeof(Magic)) != 0 || Version != SCENE_FILE_VERSION)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << Desc.FrameInterval << Desc.FrameCount << Desc.GravityZ;
+
+	uint8 bEnableSOD = Desc.bEnableSOD;
+	Ar << bEnableSOD;
+	Desc.bEnableSOD = bEnableSOD != 0;
+	SerializeTransform(Ar, Desc.Origin);
+	Ar << Desc.HashWorldCenter.X << Desc.HashWorldCenter.Y << Desc.HashWorldCenter.Z;
+	Ar << Desc.HashCellSize;
+
+	int32 Num;
+	if (!SerializeCount(Ar, Desc.ObjectIds.Num(), Num, sizeof(uint32))) return;
+	if (Ar.IsLoading()) Desc.ObjectIds.SetNum(Num);
+	for (auto& Id : Desc.ObjectIds)
+	{
+		FString Name = Id.ToString();
+		SerializeString(Ar, Name);
+		Id = FName(Name);
+	}
+
+	uint8 bRecordImpacts = Desc.bRecordImpacts;
+	uint8 bRecordIslands = Desc.bRecordIslands;
+	Ar << bRecordImpacts << Desc.ImpactImpulseThreshold << bRecordIslands;
+	Desc.bRecordImpacts = bRecordImpacts != 0;
+	Desc.bRecordIslands = bRecordIslands != 0;
+
+	SerializeProfile(Ar, Desc.Profile);
+	SerializeFlag(Ar, Desc.bRecordTelemetry);
+	SerializeFlag(Ar, Desc.bRecordStateHashes);
+	SerializeFlag(Ar, Desc.bDeterministic);
+
+	if (!SerializeCount(Ar, Desc.Bodies.Num(), Num, 1)) return;
+	if (Ar.IsLoading()) Desc.Bodies.SetNum(Num);
+	for (auto& Body : Desc.Bodies)
+	{
+		SerializeBody(Ar, Body);
+		if (Ar.IsError()) return;
+	}
+
+	if (!SerializeCount(Ar, Desc.Events.Num(), Num, 1)) return;
+	if (Ar.IsLoading()) Desc.Events.SetNum(Num);
+	for (auto& Event : Desc.Events)
+	{
+		SerializeEvent(Ar, Event);
+		if (Ar.IsError()) return;
+	}
+}
+
+bool AdvPhysSceneFile::Save(const FString& Path, FPhysSceneDesc& Desc)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Serialize(Writer, Desc);
+	return FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool AdvPhysSceneFile::Load(const FString& Path, FPhysSceneDesc& OutDesc)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path)) return false;
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader, OutDesc);
+	return !Reader.IsError();
+}
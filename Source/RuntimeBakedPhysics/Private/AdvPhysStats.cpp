@@ -0,0 +1,30 @@
+#include "AdvPhysStats.h"
+
+DEFINE_STAT(STAT_AdvPhysPlayTick);
+DEFINE_STAT(STAT_AdvPhysPlayFrame);
+DEFINE_STAT(STAT_AdvPhysSODCheck);
+DEFINE_STAT(STAT_AdvPhysSODRebuildMap);
+DEFINE_STAT(STAT_AdvPhysSODSimulateObject);
+
+DEFINE_STAT(STAT_AdvPhysRecordSimulate);
+DEFINE_STAT(STAT_AdvPhysRecordFetchResults);
+DEFINE_STAT(STAT_AdvPhysRecordReadback);
+DEFINE_STAT(STAT_AdvPhysCooking);
+
+DEFINE_STAT(STAT_AdvPhysObjectsUpdated);
+DEFINE_STAT(STAT_AdvPhysObjectsActivated);
+DEFINE_STAT(STAT_AdvPhysSODMapCells);
+DEFINE_STAT(STAT_AdvPhysBakeBytes);
+
+UE_TRACE_CHANNEL_DEFINE(AdvPhysChannel);
+
+TRACE_DECLARE_INT_COUNTER(AdvPhysObjectsUpdated, TEXT("AdvPhys/Objects Updated"));
+TRACE_DECLARE_INT_COUNTER(AdvPhysObjectsActivated, TEXT("AdvPhys/Objects Activated"));
+TRACE_DECLARE_INT_COUNTER(AdvPhysSODMapCells, TEXT("AdvPhys/SOD Map Cells"));
+TRACE_DECLARE_MEMORY_COUNTER(AdvPhysBakeBytes, TEXT("AdvPhys/Bake Bytes"));
+
+void ResetAdvPhysFrameCounters()
+{
+	TRACE_COUNTER_SET(AdvPhysObjectsUpdated, 0);
+	TRACE_COUNTER_SET(AdvPhysObjectsActivated, 0);
+}
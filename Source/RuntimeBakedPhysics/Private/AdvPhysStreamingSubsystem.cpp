@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AdvPhysStreamingSubsystem.h"
+
+void UAdvPhysStreamingSubsystem::StartGroup(FName Group, float PlayTime, float Rate)
+{
+	if (Group.IsNone() || GroupClocks.Contains(Group)) return;
+	GroupClocks.Add(Group, { GetWorld()->GetTimeSeconds(), PlayTime, Rate });
+	GroupStarted.Broadcast(Group);
+}
+
+void UAdvPhysStreamingSubsystem::SetGroupClock(FName Group, float PlayTime, float Rate)
+{
+	FGroupClock* Clock = GroupClocks.Find(Group);
+	if (!Clock) return;
+	*Clock = { GetWorld()->GetTimeSeconds(), PlayTime, Rate };
+}
+
+void UAdvPhysStreamingSubsystem::StopGroup(FName Group)
+{
+	GroupClocks.Remove(Group);
+}
+
+bool UAdvPhysStreamingSubsystem::IsGroupPlaying(FName Group) const
+{
+	return GroupClocks.Contains(Group);
+}
+
+bool UAdvPhysStreamingSubsystem::GetGroupPlayTime(FName Group, float& OutPlayTime) const
+{
+	const FGroupClock* Clock = GroupClocks.Find(Group);
+	if (!Clock) return false;
+	OutPlayTime = FMath::Max(0.0f, Clock->AnchorPlayTime + static_cast<float>(GetWorld()->GetTimeSeconds() - Clock->AnchorWorldTime) * Clock->Rate);
+	return true;
+}
@@ -0,0 +1,66 @@
+#include "AdvPhysSyntheticScene.h"
+
+FPhysShapeDesc AdvPhysSyntheticScene::MakeShape(const FString& Shape, int Index)
+{
+	FPhysShapeDesc Desc;
+	Desc.StaticFriction = 0.6f;
+	Desc.DynamicFriction = 0.5f;
+	Desc.Restitution = 0.2f;
+
+	const int Kind = Shape == TEXT("mixed") ? Index % 3 : Shape == TEXT("sphere") ? 1 : Shape == TEXT("convex") ? 2 : 0;
+	const float HalfSize = BODY_SIZE / 2.0f;
+	switch (Kind)
+	{
+	case 1:
+		Desc.Type = EPhysShapeDescType::Sphere;
+		Desc.Params = FVector3f(HalfSize, 0.0f, 0.0f);
+		break;
+	case 2:
+		// Octagonal prism, cooked like the hulls of static meshes
+		Desc.Type = EPhysShapeDescType::Convex;
+		for (int i = 0; i < 8; i++)
+		{
+			const float Angle = 2.0f * PI * i / 8;
+			Desc.Vertices.Add(FVector3f(FMath::Cos(Angle) * HalfSize, FMath::Sin(Angle) * HalfSize, -HalfSize));
+			Desc.Vertices.Add(FVector3f(FMath::Cos(Angle) * HalfSize, FMath::Sin(Angle) * HalfSize, HalfSize));
+		}
+		break;
+	default:
+		Desc.Type = EPhysShapeDescType::Box;
+		Desc.Params = FVector3f(HalfSize);
+	}
+	return Desc;
+}
+
+void AdvPhysSyntheticScene::MakePiles(int NumOfBodies, const FString& Shape, FPhysSceneDesc& OutDesc)
+{
+	const int NumOfStacks = FMath::DivideAndRoundUp(NumOfBodies, PILE_HEIGHT);
+	const int Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumOfStacks)));
+	const float Spacing = BODY_SIZE * 1.5f;
+
+	for (int i = 0; i < NumOfBodies; i++)
+	{
+		const int Stack = i / PILE_HEIGHT;
+		const int Level = i % PILE_HEIGHT;
+		const FVector Location(
+			(Stack % Side - Side / 2.0f) * Spacing,
+			(Stack / Side - Side / 2.0f) * Spacing,
+			BODY_SIZE / 2.0f + Level * BODY_SIZE * 1.01f);
+
+		FPhysBodyDesc Body;
+		Body.bDynamic = true;
+		// Slightly turned so stacks settle and topple rather than stand still
+		Body.Pose = FTransform(FRotator(0.0f, (i * 37) % 360, 0.0f), Location);
+		Body.Mass = 10.0f;
+		Body.Shapes.Add(MakeShape(Shape, i));
+		OutDesc.Bodies.Add(MoveTemp(Body));
+		OutDesc.ObjectIds.Add(FName(TEXT("Body"), i + 1));
+	}
+
+	// After the dynamic bodies, which come first in bake order
+	auto& Ground = OutDesc.Bodies.AddDefaulted_GetRef();
+	FPhysShapeDesc GroundShape = MakeShape(TEXT("box"), 0);
+	GroundShape.Params = FVector3f(Side * Spacing + BODY_SIZE, Side * Spacing + BODY_SIZE, BODY_SIZE / 2.0f);
+	Ground.Pose = FTransform(FVector(0.0f, 0.0f, -BODY_SIZE / 2.0f));
+	Ground.Shapes.Add(GroundShape);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "AdvPhysSceneDesc.h"
+
+// Bodies per stack of the synthetic piles
+#define PILE_HEIGHT 10
+#define BODY_SIZE 50.0f
+
+// Generated scenes for the benchmark and fidelity commandlets
+class AdvPhysSyntheticScene
+{
+public:
+	// Shape is box, sphere, convex or mixed, the Index-th body of a mixed pile cycles through them
+	static FPhysShapeDesc MakeShape(const FString& Shape, int Index);
+	// Stacks of PILE_HEIGHT bodies on a square grid over a ground box
+	static void MakePiles(int NumOfBodies, const FString& Shape, FPhysSceneDesc& OutDesc);
+private:
+	AdvPhysSyntheticScene() {}
+};
@@ -44,7 +44,19 @@ void ABouncyBallsSceneController::DidStartSimulateOnDemand(AAdvPhysScene* Scene,
 	Comp->SetMaterial(0, ReplacedMaterial);
 
 	if (!bPlayEffects) return;
-	
+	PlayEffects(Comp);
+}
+
+void ABouncyBallsSceneController::DidPlayImpact(AAdvPhysScene* Scene, const FPhysImpactEvent& Impact)
+{
+	Super::DidPlayImpact(Scene, Impact);
+	if (!bPlayEffects) return;
+	if (Impact.ObjA != INDEX_NONE) PlayEffects(Scene->DynamicObjEntries[Impact.ObjA].Comp);
+	if (Impact.ObjB != INDEX_NONE) PlayEffects(Scene->DynamicObjEntries[Impact.ObjB].Comp);
+}
+
+void ABouncyBallsSceneController::PlayEffects(const UStaticMeshComponent* Comp)
+{
 	TArray<UParticleSystemComponent*> Particles;
 	TArray<UAudioComponent*> Audios;
 	
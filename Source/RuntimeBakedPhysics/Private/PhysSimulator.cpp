@@ -1,21 +1,27 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 #include "PhysSimulator.h"
 
+#include "AdvPhysBakeCompare.h"
 #include "AdvPhysHashHelper.h"
 #include "AdvPhysScene.h"
+#include "AdvPhysEvent_ForceField.h"
+#include "AdvPhysSODKernel.h"
+#include "AdvPhysStats.h"
 #include "PtouConversions.h"
 
 #include "PhysXPublicCore.h"
 #include "Chaos/TriangleMeshImplicitObject.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
+#include <algorithm>
 
 PhysSimulator::PhysSimulator(): RecordData(nullptr), Scene(nullptr), bIsInitialized(false), bIsRecording(false),
-                                bWantsToStop(false)
+                                bWantsToStop(false), EventCursor(0)
 {
 }
 
 PhysSimulator::~PhysSimulator()
 {
+	StopRecordAndWait();
 }
 
 void PhysSimulator::Initialize()
@@ -37,11 +43,11 @@ void PhysSimulator::Initialize()
 	{
 		FMessageLog("PhysSimulator").Info(FText::FromString("Preparing Static PhysX Components"));
 		Foundation = PxCreateFoundation(PX_FOUNDATION_VERSION, Allocator, ErrorCallback);
+		// Connected on demand by profiles asking for it
 		Pvd = PxCreatePvd(*Foundation);
-		PxPvdTransport* Transport = PxDefaultPvdSocketTransportCreate("localhost", 5425, 10);
-		Pvd->connect(*Transport,PxPvdInstrumentationFlag::eALL);
 		Physics = PxCreatePhysics(PX_PHYSICS_VERSION, *Foundation, PxTolerancesScale(), true, Pvd);
 		Cooking = PxCreateCooking(PX_PHYSICS_VERSION, *Foundation, PxCookingParams(Physics->getTolerancesScale()));
+		Dispatcher = PxDefaultCpuDispatcherCreate(DispatcherThreads);
 	}
 	
 	CreateSceneInternal();
@@ -61,16 +67,19 @@ void PhysSimulator::Cleanup()
 	FMessageLog("PhysSimulator").Info(
 		FText::FromString("Cleaning up")
 		);
+	// The record thread steps the scene until it has exited
+	StopRecordAndWait();
 	Scene->release();
 	StaticRefCount--;
 	if (StaticRefCount == 0)
 	{
 		FMessageLog("PhysSimulator").Info(FText::FromString("Releasing Static PhysX Components"));
 		Dispatcher->release();
+		Dispatcher = nullptr;
 		Physics->release();	
 		PxPvdTransport* transport = Pvd->getTransport();
 		Pvd->release();
-		transport->release();
+		if (transport) transport->release();
 		Cooking->release();
 		Foundation->release();
 	}
@@ -78,29 +87,62 @@ void PhysSimulator::Cleanup()
 	bIsInitialized = false;
 }
 
-void PhysSimulator::ReserveEvents(int FrameCount)
+void PhysSimulator::SetEventTimeline(FPhysEventTimelinePtr Timeline)
 {
-	Events.resize(FrameCount);
+	EventTimeline = MoveTemp(Timeline);
 }
 
-void PhysSimulator::AddEvent(float Time, AAdvPhysEventBase* Event, float Interval, int FrameCount)
+void PhysSimulator::AddForceField(AAdvPhysEvent_ForceField* Field, float Interval, int FrameCount)
 {
-	const int FrameIndex = FPlatformMath::Min(Time / Interval, FrameCount - 1);
-	auto NewNode = std::make_unique<FPhysEventNode>();
-	NewNode->EventActor = Event;
-	if (!Events[FrameIndex])
-	{
-		Events[FrameIndex] = std::move(NewNode);
-		return;
-	}
-	NewNode->Next = std::move(Events[FrameIndex]);
-	Events[FrameIndex] = std::move(NewNode);
+	FPhysForceFieldEntry Entry;
+	Entry.Field = Field;
+	Entry.StartFrame = FPlatformMath::Min(Field->Time / Interval, FrameCount - 1);
+	Entry.EndFrame = FPlatformMath::Min((Field->Time + Field->Duration) / Interval, FrameCount - 1);
+	ForceFields.push_back(Entry);
 }
 
 void PhysSimulator::FreeEvents()
 {
-	Events.clear();
-	Events.shrink_to_fit();
+	EventTimeline.Reset();
+	ForceFields.clear();
+	FieldScratch.clear();
+	FieldScratch.shrink_to_fit();
+}
+
+void PhysSimulator::SetImpactRecording(bool bEnabled, float ImpulseThreshold)
+{
+	ContactCallback.bRecordImpacts = bEnabled;
+	ContactCallback.ImpulseThreshold = ImpulseThreshold;
+}
+
+void PhysSimulator::SetIslandRecording(bool bEnabled)
+{
+	ContactCallback.bTrackTouches = bEnabled;
+}
+
+void PhysSimulator::SetSubsteps(int Count)
+{
+	Substeps = FMath::Max(1, Count);
+}
+
+void PhysSimulator::SetTelemetryRecording(bool bEnabled)
+{
+	bRecordTelemetry = bEnabled;
+}
+
+void PhysSimulator::SetStateHashRecording(bool bEnabled)
+{
+	bRecordStateHashes = bEnabled;
+}
+
+void PhysSimulator::SetDeterministic(bool bEnabled)
+{
+	bDeterministic = bEnabled;
+}
+
+void PhysSimulator::SetProfile(const FPhysBakeProfile& InProfile)
+{
+	Profile = InProfile;
 }
 
 void PhysSimulator::ClearScene()
@@ -125,10 +167,31 @@ void PhysSimulator::ClearScene()
 	ConvexMeshes.clear();
 
 	ObservedBodies.clear();
+	Timings.Cooking = 0.0;
 	
 	CreateSceneInternal();
 }
 
+void PhysSimulator::ClearBodies()
+{
+	if (!bIsInitialized)
+	{
+		FMessageLog("PhysSimulator").Error(
+			FText::FromString("ClearBodies requires PhysSimulator to be initialized")
+			);
+		return;
+	}
+
+	const PxActorTypeFlags Types = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+	std::vector<PxActor*> Actors(Scene->getNbActors(Types));
+	Scene->getActors(Types, Actors.data(), Actors.size());
+	for (const auto Actor : Actors)
+	{
+		Actor->release();
+	}
+	ObservedBodies.clear();
+}
+
 void PhysSimulator::AddStaticBody(UStaticMeshComponent* Comp, EShapeType Type)
 {
 	if (!bIsInitialized)
@@ -180,13 +243,180 @@ void PhysSimulator::AddDynamicBody(UStaticMeshComponent* Comp, bool bUseSimpleGe
 		PBody->attachShape(*PShape);
 	}
 
+	// Mass is only available while simulating, components already simulating are left as they are
+	const bool bWasSimulating = Comp->IsSimulatingPhysics();
 	Comp->SetSimulatePhysics(true);
 	PxRigidBodyExt::setMassAndUpdateInertia(*PBody, Comp->GetMass());
-	Comp->SetSimulatePhysics(false);
+	Comp->SetSimulatePhysics(bWasSimulating);
+	ApplyProfileInternal(PBody);
+	PBody->userData = reinterpret_cast<void*>(static_cast<intptr_t>(ObservedBodies.size() + 1));
 	Scene->addActor(*PBody);
 	ObservedBodies.push_back(PBody);
 }
 
+static void ExportShape(const PxShape* Shape, FPhysShapeDesc& Out)
+{
+	Out.LocalPose = P2UTransform(Shape->getLocalPose());
+	PxMaterial* Material = nullptr;
+	if (Shape->getMaterials(&Material, 1) == 1)
+	{
+		Out.StaticFriction = Material->getStaticFriction();
+		Out.DynamicFriction = Material->getDynamicFriction();
+		Out.Restitution = Material->getRestitution();
+	}
+
+	switch (Shape->getGeometryType())
+	{
+	case PxGeometryType::eSPHERE:
+		{
+			PxSphereGeometry Geom;
+			Shape->getSphereGeometry(Geom);
+			Out.Type = EPhysShapeDescType::Sphere;
+			Out.Params = FVector3f(Geom.radius, 0.0f, 0.0f);
+			break;
+		}
+	case PxGeometryType::eCAPSULE:
+		{
+			PxCapsuleGeometry Geom;
+			Shape->getCapsuleGeometry(Geom);
+			Out.Type = EPhysShapeDescType::Capsule;
+			Out.Params = FVector3f(Geom.radius, Geom.halfHeight, 0.0f);
+			break;
+		}
+	case PxGeometryType::eBOX:
+		{
+			PxBoxGeometry Geom;
+			Shape->getBoxGeometry(Geom);
+			Out.Type = EPhysShapeDescType::Box;
+			Out.Params = FVector3f(Geom.halfExtents.x, Geom.halfExtents.y, Geom.halfExtents.z);
+			break;
+		}
+	case PxGeometryType::eCONVEXMESH:
+		{
+			PxConvexMeshGeometry Geom;
+			Shape->getConvexMeshGeometry(Geom);
+			Out.Type = EPhysShapeDescType::Convex;
+			Out.Scale = FVector3f(Geom.scale.scale.x, Geom.scale.scale.y, Geom.scale.scale.z);
+			const PxVec3* Verts = Geom.convexMesh->getVertices();
+			for (PxU32 i = 0; i < Geom.convexMesh->getNbVertices(); i++)
+			{
+				Out.Vertices.Add(FVector3f(Verts[i].x, Verts[i].y, Verts[i].z));
+			}
+			break;
+		}
+	case PxGeometryType::eTRIANGLEMESH:
+		{
+			PxTriangleMeshGeometry Geom;
+			Shape->getTriangleMeshGeometry(Geom);
+			const auto Mesh = Geom.triangleMesh;
+			Out.Type = EPhysShapeDescType::TriMesh;
+			Out.Scale = FVector3f(Geom.scale.scale.x, Geom.scale.scale.y, Geom.scale.scale.z);
+			const PxVec3* Verts = Mesh->getVertices();
+			for (PxU32 i = 0; i < Mesh->getNbVertices(); i++)
+			{
+				Out.Vertices.Add(FVector3f(Verts[i].x, Verts[i].y, Verts[i].z));
+			}
+			const bool b16Bit = Mesh->getTriangleMeshFlags() & PxTriangleMeshFlag::e16_BIT_INDICES;
+			for (PxU32 i = 0; i < Mesh->getNbTriangles() * 3; i++)
+			{
+				Out.Indices.Add(b16Bit ? static_cast<const PxU16*>(Mesh->getTriangles())[i] : static_cast<const PxU32*>(Mesh->getTriangles())[i]);
+			}
+			break;
+		}
+	default:
+		FMessageLog("PhysSimulator").Warning(FText::FromString("ExportScene skipped a shape of unsupported geometry"));
+	}
+}
+
+static void ExportBody(const PxRigidActor* Body, FPhysBodyDesc& Out)
+{
+	Out.Pose = P2UTransform(Body->getGlobalPose());
+	if (const auto Dynamic = Body->is<PxRigidDynamic>())
+	{
+		Out.bDynamic = true;
+		Out.Mass = Dynamic->getMass();
+		const auto Linear = Dynamic->getLinearVelocity();
+		const auto Angular = Dynamic->getAngularVelocity();
+		Out.LinearVelocity = FVector3f(Linear.x, Linear.y, Linear.z);
+		Out.AngularVelocity = FVector3f(Angular.x, Angular.y, Angular.z);
+	}
+
+	std::vector<PxShape*> Shapes(Body->getNbShapes());
+	Body->getShapes(Shapes.data(), Shapes.size());
+	for (const auto Shape : Shapes)
+	{
+		ExportShape(Shape, Out.Shapes.AddDefaulted_GetRef());
+	}
+}
+
+void PhysSimulator::ExportScene(FPhysSceneDesc& OutDesc) const
+{
+	if (!bIsInitialized)
+	{
+		FMessageLog("PhysSimulator").Error(
+			FText::FromString("ExportScene requires PhysSimulator to be initialized")
+			);
+		return;
+	}
+
+	OutDesc.Bodies.Empty();
+	for (const auto Body : ObservedBodies)
+	{
+		ExportBody(Body, OutDesc.Bodies.AddDefaulted_GetRef());
+	}
+
+	std::vector<PxActor*> Statics(Scene->getNbActors(PxActorTypeFlag::eRIGID_STATIC));
+	Scene->getActors(PxActorTypeFlag::eRIGID_STATIC, Statics.data(), Statics.size());
+	for (const auto Actor : Statics)
+	{
+		ExportBody(Actor->is<PxRigidStatic>(), OutDesc.Bodies.AddDefaulted_GetRef());
+	}
+}
+
+void PhysSimulator::ImportScene(const FPhysSceneDesc& Desc)
+{
+	if (!bIsInitialized)
+	{
+		FMessageLog("PhysSimulator").Error(
+			FText::FromString("ImportScene requires PhysSimulator to be initialized")
+			);
+		return;
+	}
+
+	for (const auto& BodyDesc : Desc.Bodies)
+	{
+		const PxTransform PTransform = U2PTransform(BodyDesc.Pose);
+		PxRigidActor* PBody;
+		if (BodyDesc.bDynamic)
+		{
+			PBody = Physics->createRigidDynamic(PTransform);
+		}
+		else
+		{
+			PBody = Physics->createRigidStatic(PTransform);
+		}
+
+		for (const auto& ShapeDesc : BodyDesc.Shapes)
+		{
+			const auto PShape = CreateShapeInternal(ShapeDesc);
+			if (PShape == nullptr) continue;
+			PBody->attachShape(*PShape);
+			PShape->release();
+		}
+
+		if (const auto Dynamic = PBody->is<PxRigidDynamic>())
+		{
+			PxRigidBodyExt::setMassAndUpdateInertia(*Dynamic, BodyDesc.Mass);
+			Dynamic->setLinearVelocity(PxVec3(BodyDesc.LinearVelocity.X, BodyDesc.LinearVelocity.Y, BodyDesc.LinearVelocity.Z));
+			Dynamic->setAngularVelocity(PxVec3(BodyDesc.AngularVelocity.X, BodyDesc.AngularVelocity.Y, BodyDesc.AngularVelocity.Z));
+			ApplyProfileInternal(Dynamic);
+			Dynamic->userData = reinterpret_cast<void*>(static_cast<intptr_t>(ObservedBodies.size() + 1));
+			ObservedBodies.push_back(Dynamic);
+		}
+		Scene->addActor(*PBody);
+	}
+}
+
 void PhysSimulator::StartRecord(
 	FPhysRecordData* Destination,
 	float RecordInterval,
@@ -209,20 +439,67 @@ void PhysSimulator::StartRecord(
 	RecordData->Progress = 0.0f;
 	RecordData->FrameCount = FrameCount;
 	RecordData->FrameInterval = RecordInterval;
+	RecordData->ObjectCount = ObservedBodies.size();
 	RecordData->ObjLocRot.Empty();
 	RecordData->ObjLocRot.Reserve(FrameCount * ObservedBodies.size());
 	RecordData->ObjLocRot.AddZeroed(FrameCount * ObservedBodies.size());
 
+	// Contacts are only reported to the callback for scenes recording them
+	const bool bRecordImpacts = ContactCallback.bRecordImpacts;
+	const bool bRecordIslands = ContactCallback.bTrackTouches;
+	const PxU32 Report = GetFilterReportInternal();
+	Scene->setFilterShaderData(&Report, sizeof(Report));
+	Scene->setSimulationEventCallback(Report & (ReportImpacts | ReportTouches) ? &ContactCallback : nullptr);
+	ContactCallback.Pending.clear();
+	ContactCallback.TouchCounts.clear();
+	RecordData->Impacts.Empty();
+	RecordData->ImpactFrameStarts.Empty();
+	if (bRecordImpacts)
+	{
+		RecordData->ImpactFrameStarts.Reserve(FrameCount + 1);
+		RecordData->ImpactFrameStarts.Add(0);
+	}
+	RecordData->ObjIsland.Empty();
+	if (bRecordIslands)
+	{
+		RecordData->ObjIsland.AddUninitialized(FrameCount * ObservedBodies.size());
+	}
+	RecordData->Telemetry.Empty();
+	if (bRecordTelemetry)
+	{
+		RecordData->Telemetry.AddZeroed(FrameCount);
+	}
+	RecordData->FrameHashes.Empty();
+	if (bRecordStateHashes)
+	{
+		RecordData->FrameHashes.AddZeroed(FrameCount);
+	}
+
 	if (RecordData->bEnableSOD)
 	{
 		RecordData->ObjSOD.Empty();
 		RecordData->ObjSOD.Reserve(FrameCount * ObservedBodies.size());
 		RecordData->ObjSOD.AddZeroed(FrameCount * ObservedBodies.size());
+
+		const int Stride = AdvPhysSODKernel::GetStride(ObservedBodies.size());
+		RecordData->SODSoAStride = Stride;
+		RecordData->ObjSODSoA.Empty();
+		RecordData->ObjSODSoA.AddZeroed(FrameCount * SOD_SOA_PLANES * Stride);
+		for (int i = 0; i < FrameCount; i++)
+		{
+			AdvPhysSODKernel::ResetPadding(&RecordData->ObjSODSoA[i * SOD_SOA_PLANES * Stride], ObservedBodies.size(), Stride);
+		}
 	}
 	
+	const double Cooking = Timings.Cooking;
+	Timings = PhysRecordTimings();
+	Timings.Cooking = Cooking;
+
+	// The previous record has finished, its thread only needs joining
+	if (RecordThread.joinable()) RecordThread.join();
 	bWantsToStop = false;
+	bIsRecording = true;
 	RecordThread = std::thread(&PhysSimulator::RecordInternal, this);
-	RecordThread.detach();
 }
 
 void PhysSimulator::StopRecord()
@@ -237,6 +514,13 @@ void PhysSimulator::StopRecord()
 	bWantsToStop = true;
 }
 
+void PhysSimulator::StopRecordAndWait()
+{
+	if (!RecordThread.joinable()) return;
+	bWantsToStop = true;
+	RecordThread.join();
+}
+
 bool PhysSimulator::IsInitialized() const
 {
 	return bIsInitialized;
@@ -250,6 +534,9 @@ bool PhysSimulator::IsRecording() const
 void PhysSimulator::RecordInternal()
 {
 	if (Controller) Controller->BeginRecordScene(this);
+	EventCursor = 0;
+	const float StepInterval = RecordData->FrameInterval / Substeps;
+	PhysBroadphasePairCounter Broadphase;
 	for (int i = 0; i < RecordData->FrameCount; i++)
 	{
 		if (bWantsToStop)
@@ -258,21 +545,74 @@ void PhysSimulator::RecordInternal()
 			return;
 		}
 
-		HandleEventsInternal(i);
+		double Start = FPlatformTime::Seconds();
+		const int NumOfEvents = HandleEventsInternal(i);
 		if (Controller) Controller->RecordSceneTick(this, i);
+		double Now = FPlatformTime::Seconds();
+		Timings.Events += Now - Start;
 		
-		Scene->simulate(RecordData->FrameInterval);
-		Scene->fetchResults(true);
-		for (int j = 0; j < ObservedBodies.size(); j++)
+		ContactCallback.Frame = i;
+		const double FrameSimulateStart = Timings.Simulate + Timings.FetchResults;
+		for (int Step = 0; Step < Substeps; Step++)
 		{
-			auto& Frame = RecordData->ObjLocRot[i * ObservedBodies.size() + j];
-			const auto& Pose = ObservedBodies[j]->getGlobalPose();
-			Frame.Location = P2UVector(Pose.p);
-			Frame.Rotation = UE::Math::TRotator(P2UQuat(Pose.q));
+			// Forces only last for one step
+			Start = Now;
+			{
+				ADVPHYS_SCOPE_CYCLE(AdvPhysRecordSimulate);
+				ApplyForceFieldsInternal(i);
+				Scene->simulate(StepInterval);
+			}
+			Now = FPlatformTime::Seconds();
+			Timings.Simulate += Now - Start;
+			Start = Now;
+			{
+				ADVPHYS_SCOPE_CYCLE(AdvPhysRecordFetchResults);
+				Scene->fetchResults(true);
+			}
+			Now = FPlatformTime::Seconds();
+			Timings.FetchResults += Now - Start;
+			if (bRecordTelemetry) Broadphase.Update(Scene);
+		}
+		if (bRecordTelemetry)
+		{
+			auto& Telemetry = RecordData->Telemetry[i];
+			Telemetry.SimulateTime = Timings.Simulate + Timings.FetchResults - FrameSimulateStart;
+			Telemetry.Events = NumOfEvents;
+			const PhysFrameActivity Activity = PhysGetFrameActivity(Scene, ObservedBodies, Broadphase);
+			Telemetry.AwakeBodies = Activity.AwakeBodies;
+			Telemetry.ContactPairs = Activity.ContactPairs;
+			Telemetry.NarrowphasePairs = Activity.NarrowphasePairs;
+			Telemetry.BroadphasePairs = Activity.BroadphasePairs;
+		}
+
+		Start = Now;
+		if (ContactCallback.bRecordImpacts) RecordImpactsInternal(i);
+		if (ContactCallback.bTrackTouches) RecordIslandsInternal(i);
+		Now = FPlatformTime::Seconds();
+		Timings.Contacts += Now - Start;
+
+		Start = Now;
+		{
+			ADVPHYS_SCOPE_CYCLE(AdvPhysRecordReadback);
+			for (int j = 0; j < ObservedBodies.size(); j++)
+			{
+				auto& Frame = RecordData->ObjLocRot[i * ObservedBodies.size() + j];
+				const auto& Pose = ObservedBodies[j]->getGlobalPose();
+				Frame.Location = P2UVector(Pose.p);
+				Frame.Rotation = UE::Math::TRotator(P2UQuat(Pose.q));
+			}
+			if (bRecordStateHashes)
+			{
+				RecordData->FrameHashes[i] = AdvPhysBakeCompare::HashFrame(*RecordData, i);
+			}
 		}
+		Now = FPlatformTime::Seconds();
+		Timings.Readback += Now - Start;
 
 		if (RecordData->bEnableSOD)
 		{
+			Start = Now;
+			float* FrameSoA = &RecordData->ObjSODSoA[i * SOD_SOA_PLANES * RecordData->SODSoAStride];
 			for (int j = 0; j < ObservedBodies.size(); j++)
 			{
 				auto& Frame = RecordData->ObjSOD[i * ObservedBodies.size() + j];
@@ -285,33 +625,154 @@ void PhysSimulator::RecordInternal()
 					Frame.EndHash
 					);
 				Frame.Bounds = FBox(P2UVector(Bounds.minimum), P2UVector(Bounds.maximum));
+				AdvPhysSODKernel::WriteBounds(FrameSoA, RecordData->SODSoAStride, j, Frame.Bounds.Min, Frame.Bounds.Max);
 			}
+			Timings.Hashing += FPlatformTime::Seconds() - Start;
 		}
 		RecordData->Progress = static_cast<float>(i + 1) / RecordData->FrameCount;
 	}
 	if (Controller) Controller->EndRecordScene(this);
+	RecordData->UpdateChecksum();
 	RecordData->Finished = true;
 	bIsRecording = false;
 }
 
-void PhysSimulator::HandleEventsInternal(int Frame)
+int PhysSimulator::HandleEventsInternal(int Frame)
+{
+	if (!EventTimeline) return 0;
+	const auto& Timeline = *EventTimeline;
+	int NumOfEvents = 0;
+	for (; EventCursor < Timeline.Num() && Timeline[EventCursor].Frame <= Frame; EventCursor++)
+	{
+		const auto& Entry = Timeline[EventCursor];
+		if (Entry.bIsContinuous) continue;
+		QueryEventBodiesInternal(Entry.EventActor, EventBodies);
+		Entry.EventActor->DoEventPhysX(EventBodies);
+		NumOfEvents++;
+	}
+	return NumOfEvents;
+}
+
+void PhysSimulator::ApplyForceFieldsInternal(int Frame)
+{
+	for (const auto& Entry : ForceFields)
+	{
+		if (Frame < Entry.StartFrame || Frame > Entry.EndFrame) continue;
+		const auto Field = Entry.Field;
+		QueryEventBodiesInternal(Field, EventBodies);
+		if (EventBodies.empty()) continue;
+
+		const int Count = EventBodies.size();
+		const int Stride = Align(Count, 4);
+		FieldScratch.assign(Stride * 6, 0.0f);
+		float* PosX = FieldScratch.data();
+		float* PosY = PosX + Stride;
+		float* PosZ = PosY + Stride;
+		float* ForceX = PosZ + Stride;
+		float* ForceY = ForceX + Stride;
+		float* ForceZ = ForceY + Stride;
+		
+		for (int i = 0; i < Count; i++)
+		{
+			const auto P = EventBodies[i]->getGlobalPose().p;
+			PosX[i] = P.x;
+			PosY[i] = P.y;
+			PosZ[i] = P.z;
+		}
+
+		const float FieldTime = (Frame - Entry.StartFrame) * RecordData->FrameInterval;
+		Field->ComputeForces(PosX, PosY, PosZ, Stride, FieldTime, ForceX, ForceY, ForceZ);
+
+		const auto Mode = Field->bIgnoreMass ? PxForceMode::eACCELERATION : PxForceMode::eFORCE;
+		for (int i = 0; i < Count; i++)
+		{
+			const auto Body = EventBodies[i];
+			if (Body->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC) continue;
+			Body->addForce(PxVec3(ForceX[i], ForceY[i], ForceZ[i]), Mode);
+		}
+	}
+}
+
+void PhysSimulator::RecordImpactsInternal(int Frame)
+{
+	// Morton order keeps impacts close in space close in the stream
+	auto& Pending = ContactCallback.Pending;
+	ImpactOrder.clear();
+	for (int i = 0; i < Pending.size(); i++)
+	{
+		ImpactOrder.emplace_back(AdvPhysHashHelper::GetHash(Pending[i].Location, RecordData->HashWorldCenter, RecordData->HashCellSize), i);
+	}
+	std::sort(ImpactOrder.begin(), ImpactOrder.end());
+	
+	for (const auto& Entry : ImpactOrder)
+	{
+		const auto& Impact = Pending[Entry.second];
+		RecordData->Impacts.Add({ Impact.Frame, Impact.ObjA, Impact.ObjB, FVector3f(Impact.Location.x, Impact.Location.y, Impact.Location.z), Impact.Impulse });
+	}
+	RecordData->ImpactFrameStarts.Add(RecordData->Impacts.Num());
+	Pending.clear();
+}
+
+void PhysSimulator::RecordIslandsInternal(int Frame)
+{
+	const int NumOfBodies = ObservedBodies.size();
+	PhysFindIslands(ContactCallback, NumOfBodies, IslandParents, &RecordData->ObjIsland[Frame * NumOfBodies]);
+}
+
+struct FEventOverlapCallback : PxOverlapCallback
+{
+	explicit FEventOverlapCallback(std::vector<PxRigidDynamic*>& Out) :
+		PxOverlapCallback(Hits, UE_ARRAY_COUNT(Hits)),
+		Out(Out)
+	{ }
+
+	virtual PxAgain processTouches(const PxOverlapHit* Buffer, PxU32 NbHits) override
+	{
+		for (PxU32 i = 0; i < NbHits; i++)
+		{
+			if (const auto Body = Buffer[i].actor->is<PxRigidDynamic>())
+				Out.push_back(Body);
+		}
+		return true;
+	}
+
+	PxOverlapHit Hits[256];
+	std::vector<PxRigidDynamic*>& Out;
+};
+
+void PhysSimulator::QueryEventBodiesInternal(const AAdvPhysEventBase* Event, std::vector<PxRigidDynamic*>& OutBodies)
 {
-	auto& EventCursor = Events[Frame];
-	while (EventCursor)
+	FVector Center;
+	float Radius;
+	if (!Event->GetInfluenceSphere(Center, Radius))
 	{
-		EventCursor->EventActor->DoEventPhysX(ObservedBodies);
-		EventCursor = EventCursor->Next;
+		OutBodies = ObservedBodies;
+		return;
 	}
+
+	OutBodies.clear();
+	FEventOverlapCallback Callback(OutBodies);
+	const PxQueryFilterData FilterData(PxQueryFlag::eDYNAMIC | PxQueryFlag::eNO_BLOCK);
+	Scene->overlap(PxSphereGeometry(Radius), PxTransform(U2PVector(Center)), Callback, FilterData);
+
+	// Compound bodies are reported once per overlapping shape
+	std::sort(OutBodies.begin(), OutBodies.end());
+	OutBodies.erase(std::unique(OutBodies.begin(), OutBodies.end()), OutBodies.end());
 }
 
 void PhysSimulator::CreateSceneInternal()
 {
 	PxSceneDesc SceneDesc(Physics->getTolerancesScale());
-	Dispatcher = PxDefaultCpuDispatcherCreate(2);
 	SceneDesc.cpuDispatcher	= Dispatcher;
-	SceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	const PhysSceneSettings Settings = GetSceneSettingsInternal();
+	PhysApplySceneSettings(SceneDesc, Settings);
+	const PxU32 Report = GetFilterReportInternal();
+	SceneDesc.filterShaderData = &Report;
+	SceneDesc.filterShaderDataSize = sizeof(Report);
 	Scene = Physics->createScene(SceneDesc);
-	
+	PhysAddBroadPhaseRegions(Scene, Settings);
+
+	ConnectPvdInternal();
 	PxPvdSceneClient* PvdClient = Scene->getScenePvdClient();
 	if (PvdClient)
 	{
@@ -321,6 +782,53 @@ void PhysSimulator::CreateSceneInternal()
 	}
 }
 
+void PhysSimulator::ApplyProfileInternal(PxRigidDynamic* Body) const
+{
+	PhysApplyBodySettings(Body, GetSceneSettingsInternal());
+}
+
+PhysSceneSettings PhysSimulator::GetSceneSettingsInternal() const
+{
+	PhysSceneSettings Settings;
+	Settings.bMultiBoxPruning = Profile.Broadphase == MultiBoxPruning;
+	Settings.WorldBounds = PxBounds3(U2PVector(Profile.WorldBounds.Min), U2PVector(Profile.WorldBounds.Max));
+	Settings.MBPSubdivisions = Profile.MBPSubdivisions;
+	Settings.bEnablePCM = Profile.bEnablePCM;
+	Settings.bEnableStabilization = Profile.bEnableStabilization;
+	Settings.bEnableCCD = Profile.bEnableCCD;
+	Settings.PositionIterations = Profile.PositionIterations;
+	Settings.VelocityIterations = Profile.VelocityIterations;
+	Settings.SleepThreshold = Profile.SleepThreshold;
+	Settings.bDeterministic = bDeterministic;
+	return Settings;
+}
+
+PxU32 PhysSimulator::GetFilterReportInternal() const
+{
+	return PhysGetContactReport(ContactCallback.bRecordImpacts, ContactCallback.bTrackTouches, GetSceneSettingsInternal());
+}
+
+void PhysSimulator::ConnectPvdInternal() const
+{
+	if (!Profile.bConnectPvd || Pvd->isConnected()) return;
+	// A transport left over from an earlier connection may point elsewhere
+	if (PxPvdTransport* OldTransport = Pvd->getTransport())
+	{
+		Pvd->disconnect();
+		OldTransport->release();
+	}
+	PvdHost = TCHAR_TO_ANSI(*Profile.PvdHost);
+	PxPvdTransport* Transport = PxDefaultPvdSocketTransportCreate(PvdHost.c_str(), Profile.PvdPort, 10);
+	if (!Pvd->connect(*Transport, PxPvdInstrumentationFlag::eALL))
+	{
+		FMessageLog("PhysSimulator").Warning(FText::Format(
+			FText::FromString("Could not connect to PVD at {0}:{1}"),
+			FText::FromString(Profile.PvdHost),
+			Profile.PvdPort
+			));
+	}
+}
+
 void PhysSimulator::GetShapeInternal(const UStaticMeshComponent* Comp, EShapeType Type, PhysCompoundShape& OutShape)
 {
 	const auto& UPhysMat = Comp->GetStaticMesh()->GetBodySetup()->GetPhysMaterial();
@@ -375,7 +883,10 @@ void PhysSimulator::GetShapeInternal(const UStaticMeshComponent* Comp, EShapeTyp
 			MeshDesc.triangles.stride = 3*sizeof(PxU32);
 			MeshDesc.triangles.data = PIndices.data();
 
+			ADVPHYS_SCOPE_CYCLE(AdvPhysCooking);
+			const double CookStart = FPlatformTime::Seconds();
 			const auto TriMesh = Cooking->createTriangleMesh(MeshDesc, Physics->getPhysicsInsertionCallback());
+			Timings.Cooking += FPlatformTime::Seconds() - CookStart;
 			PxTriangleMeshGeometry TriGeom;
 			TriGeom.triangleMesh = TriMesh;
 			TriGeom.scale = PxMeshScale(PScale);
@@ -574,7 +1085,11 @@ PxConvexMesh* PhysSimulator::GetConvexMeshInternal(UStaticMesh* Mesh, int Convex
 	{
 		PxDefaultMemoryOutputStream Buf;
 		PxConvexMeshCookingResult::Enum Res;
-		if (!Cooking->cookConvexMesh(convexDesc, Buf, &Res)) return nullptr;
+		ADVPHYS_SCOPE_CYCLE(AdvPhysCooking);
+		const double CookStart = FPlatformTime::Seconds();
+		const bool bCooked = Cooking->cookConvexMesh(convexDesc, Buf, &Res);
+		Timings.Cooking += FPlatformTime::Seconds() - CookStart;
+		if (!bCooked) return nullptr;
 		PxDefaultMemoryInputData Input(Buf.getData(), Buf.getSize());
 		const auto ConvexMesh = Physics->createConvexMesh(Input);
 		if (ConvexMesh == nullptr)
@@ -592,3 +1107,69 @@ PxConvexMesh* PhysSimulator::GetConvexMeshInternal(UStaticMesh* Mesh, int Convex
 		return ConvexMesh;
 	}
 }
+
+PxShape* PhysSimulator::CreateShapeInternal(const FPhysShapeDesc& Desc)
+{
+	ADVPHYS_SCOPE_CYCLE(AdvPhysCooking);
+	const double CookStart = FPlatformTime::Seconds();
+	const auto PMaterial = Physics->createMaterial(Desc.StaticFriction, Desc.DynamicFriction, Desc.Restitution);
+	const PxMeshScale PScale(PxVec3(Desc.Scale.X, Desc.Scale.Y, Desc.Scale.Z));
+	PxShape* PShape = nullptr;
+
+	switch (Desc.Type)
+	{
+	case EPhysShapeDescType::Sphere:
+		PShape = Physics->createShape(PxSphereGeometry(Desc.Params.X), *PMaterial);
+		break;
+	case EPhysShapeDescType::Capsule:
+		PShape = Physics->createShape(PxCapsuleGeometry(Desc.Params.X, Desc.Params.Y), *PMaterial);
+		break;
+	case EPhysShapeDescType::Box:
+		PShape = Physics->createShape(PxBoxGeometry(Desc.Params.X, Desc.Params.Y, Desc.Params.Z), *PMaterial);
+		break;
+	case EPhysShapeDescType::Convex:
+		{
+			// Vertices are already a cooked hull, recooking them keeps it as it is
+			PxConvexMeshDesc ConvexDesc;
+			ConvexDesc.points.count = Desc.Vertices.Num();
+			ConvexDesc.points.stride = sizeof(FVector3f);
+			ConvexDesc.points.data = Desc.Vertices.GetData();
+			ConvexDesc.flags = PxConvexFlag::eCOMPUTE_CONVEX | PxConvexFlag::eDISABLE_MESH_VALIDATION | PxConvexFlag::eFAST_INERTIA_COMPUTATION;
+
+			PxDefaultMemoryOutputStream Buf;
+			if (!Cooking->cookConvexMesh(ConvexDesc, Buf)) break;
+			PxDefaultMemoryInputData Input(Buf.getData(), Buf.getSize());
+			const auto ConvexMesh = Physics->createConvexMesh(Input);
+			if (ConvexMesh == nullptr) break;
+			PShape = Physics->createShape(PxConvexMeshGeometry(ConvexMesh, PScale), *PMaterial);
+			ConvexMesh->release();
+			break;
+		}
+	case EPhysShapeDescType::TriMesh:
+		{
+			PxTriangleMeshDesc MeshDesc;
+			MeshDesc.points.count = Desc.Vertices.Num();
+			MeshDesc.points.stride = sizeof(FVector3f);
+			MeshDesc.points.data = Desc.Vertices.GetData();
+			MeshDesc.triangles.count = Desc.Indices.Num() / 3;
+			MeshDesc.triangles.stride = 3 * sizeof(uint32);
+			MeshDesc.triangles.data = Desc.Indices.GetData();
+
+			const auto TriMesh = Cooking->createTriangleMesh(MeshDesc, Physics->getPhysicsInsertionCallback());
+			if (TriMesh == nullptr) break;
+			PShape = Physics->createShape(PxTriangleMeshGeometry(TriMesh, PScale), *PMaterial);
+			TriMesh->release();
+			break;
+		}
+	}
+	PMaterial->release();
+	Timings.Cooking += FPlatformTime::Seconds() - CookStart;
+
+	if (PShape == nullptr)
+	{
+		FMessageLog("PhysSimulator").Warning(FText::FromString("ImportScene failed to create a shape"));
+		return nullptr;
+	}
+	PShape->setLocalPose(U2PTransform(Desc.LocalPose));
+	return PShape;
+}
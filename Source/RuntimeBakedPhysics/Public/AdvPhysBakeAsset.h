@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvPhysDataTypes.h"
+#include "Engine/DataAsset.h"
+#include "AdvPhysBakeAsset.generated.h"
+
+/**
+ * Finished bake stored in a package. The payload lives in bulk data so cooked builds can stream it,
+ * and it is only deserialized when a scene asks for it.
+ */
+UCLASS(BlueprintType)
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysBakeAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Serialize(FArchive& Ar) override;
+
+	void SetRecordData(const FPhysRecordData& Data);
+	// Reads the payload, safe to call off the game thread
+	FPhysRecordDataPtr LoadRecordData();
+	// Bytes of the serialized payload held in memory, which is only the case until it can be reloaded from the package
+	int64 GetResidentPayloadSize() const;
+
+	UPROPERTY(VisibleAnywhere)
+	int FrameCount;
+
+	UPROPERTY(VisibleAnywhere)
+	float FrameInterval;
+
+	UPROPERTY(VisibleAnywhere)
+	int ObjectCount;
+
+	UPROPERTY(VisibleAnywhere)
+	int64 PayloadSize;
+
+private:
+	FByteBulkData Payload;
+	mutable FCriticalSection PayloadLock;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AdvPhysBakeBenchmarkCommandlet.generated.h"
+
+// Records synthetic piles of bodies, or the scenes of a map, and writes per-phase timings and memory to JSON and CSV.
+// -run=AdvPhysBakeBenchmark [-map=/Game/Maps/X] [-counts=100,400,1600] [-shape=box|sphere|convex|mixed]
+//   [-frames=300] [-interval=0.0166] [-substeps=1] [-sod] [-cellsize=100] [-impacts] [-islands] [-threads=N] [-out=Path]
+//   [-profiles=/Game/Profiles/A.A,/Game/Profiles/B.B], recording every scene once per profile
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysBakeBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAdvPhysBakeBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AdvPhysBakeCacheSubsystem.generated.h"
+
+class AAdvPhysScene;
+
+/**
+ * Keeps resident bakes of a world under AdvPhys.BakeMemoryBudgetMB.
+ * Over budget, bakes of idle scenes are evicted least recently used first, scenes reload them when played again.
+ */
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysBakeCacheSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Called when a scene holds a finished bake, by recording or loading it
+	void NotifyBakeResident(AAdvPhysScene* Scene);
+	// Marks the bake of Scene as most recently used
+	void Touch(AAdvPhysScene* Scene);
+	void Remove(AAdvPhysScene* Scene);
+
+	// Evicts idle bakes until the resident ones fit the budget
+	UFUNCTION(BlueprintCallable)
+		void EnforceBudget();
+
+	// Bakes shared by several scenes count once
+	UFUNCTION(BlueprintCallable)
+		int64 GetResidentBytes() const;
+	UFUNCTION(BlueprintCallable)
+		int64 GetBudgetBytes() const;
+
+private:
+	// World seconds each scene last used its bake at
+	TMap<TWeakObjectPtr<AAdvPhysScene>, double> LastUsedTimes;
+};
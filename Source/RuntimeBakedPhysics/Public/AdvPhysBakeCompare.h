@@ -0,0 +1,33 @@
+#pragma once
+#include "AdvPhysDataTypes.h"
+
+// Where two bakes of the same scene first differ
+struct FPhysBakeDifference
+{
+	// Set when the bakes cannot be compared frame by frame, such as different frame or object counts
+	FString Mismatch;
+	// First frame with a pose differing by more than the tolerances, INDEX_NONE if there is none
+	int Frame = INDEX_NONE;
+	// First object differing in that frame
+	int ObjIndex = INDEX_NONE;
+	FName ObjectId;
+	float LocationError = 0.0f;
+	float RotationError = 0.0f;
+
+	bool IsIdentical() const
+	{
+		return Mismatch.IsEmpty() && Frame == INDEX_NONE;
+	}
+};
+
+class RUNTIMEBAKEDPHYSICS_API AdvPhysBakeCompare
+{
+public:
+	// Same hashes RecordInternal writes into FrameHashes
+	static uint64 HashFrame(const FPhysRecordData& Data, int Frame);
+	// Compares the poses of two bakes, exactly if both tolerances are 0, locations in units and rotations in degrees.
+	// Frame hashes present in both are used to skip equal frames.
+	static FPhysBakeDifference Compare(const FPhysRecordData& A, const FPhysRecordData& B, float LocationTolerance = 0.0f, float RotationTolerance = 0.0f);
+private:
+	AdvPhysBakeCompare() {}
+};
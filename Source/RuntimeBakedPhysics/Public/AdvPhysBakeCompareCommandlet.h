@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AdvPhysBakeCompareCommandlet.generated.h"
+
+// Reports the first frame and object at which two bake assets differ. Returns 0 if they are identical, 1 if not.
+// -run=AdvPhysBakeCompare -a=/Game/Bakes/A.A -b=/Game/Bakes/B.B [-loctol=0] [-rottol=0], in units and degrees
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysBakeCompareCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAdvPhysBakeCompareCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
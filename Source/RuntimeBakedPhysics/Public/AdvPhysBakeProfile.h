@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvPhysDataTypes.h"
+#include "Engine/DataAsset.h"
+#include "AdvPhysBakeProfile.generated.h"
+
+/**
+ * Named set of PhysX settings to bake with, shared by the scenes referencing it.
+ * Compare profiles on a map with -run=AdvPhysBakeBenchmark -map= -profiles=.
+ */
+UCLASS(BlueprintType)
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysBakeProfile : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere)
+	FPhysBakeProfile Profile;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "AdvPhysDataTypes.h"
+#include "AdvPhysSceneDesc.h"
+
+class FSocket;
+
+// Hands a scene to a bake worker and fills a bake with the frames it streams back, as PhysSimulator would
+class RUNTIMEBAKEDPHYSICS_API FAdvPhysBakeWorkerClient
+{
+public:
+	~FAdvPhysBakeWorkerClient();
+
+	// Address is host:port of a worker run with -run=AdvPhysBakeWorker
+	bool Start(const FString& Address, FPhysSceneDesc Desc, FPhysRecordDataPtr Destination);
+	void Stop();
+	bool IsRunning() const;
+	// Why the last job ended before its bake finished, empty if it did not
+	FString GetError() const;
+
+private:
+	void RunInternal(TArray<uint8> Job, FPhysRecordDataPtr Destination);
+	void SetError(const FString& Reason);
+
+	FSocket* Socket = nullptr;
+	TFuture<void> Task;
+	TAtomic<bool> bCancel { false };
+	mutable FCriticalSection ErrorLock;
+	FString Error;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AdvPhysBakeWorkerCommandlet.generated.h"
+
+// Bakes scene descriptions sent over a local socket and streams the frames back.
+// -run=AdvPhysBakeWorker [-port=7781] [-threads=N] [-once]
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysBakeWorkerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAdvPhysBakeWorkerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
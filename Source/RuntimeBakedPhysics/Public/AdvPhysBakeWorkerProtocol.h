@@ -0,0 +1,40 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "AdvPhysDataTypes.h"
+
+class FSocket;
+
+#define ADVPHYS_BAKE_WORKER_DEFAULT_PORT 7781
+
+// Messages between a bake worker and its clients, each a type byte and a length prefixed payload
+enum class EAdvPhysBakeMessage : uint8
+{
+	// Client: FPhysSceneDesc to bake
+	Job,
+	// Worker: layout of the bake, sent once before any frames
+	Header,
+	// Worker: first frame, number of frames and their tracks
+	Frames,
+	// Worker: impacts of the whole bake, closes the job
+	Finished,
+	// Worker: reason the job could not be baked
+	Failed
+};
+
+class AdvPhysBakeWorkerProtocol
+{
+public:
+	static bool Send(FSocket* Socket, EAdvPhysBakeMessage Type, const TArray<uint8>& Payload);
+	// Blocks until a whole message arrived, false once the connection is lost, bCancel is set or Timeout seconds passed if positive
+	static bool Receive(FSocket* Socket, EAdvPhysBakeMessage& OutType, TArray<uint8>& OutPayload, const TAtomic<bool>* bCancel = nullptr, float Timeout = 0.0f);
+
+	// Loading lays out the tracks of the bake for its frames to arrive
+	static void SerializeHeader(FArchive& Ar, FPhysRecordData& Data);
+	// Loading takes the range of frames from the archive rather than the arguments
+	static void SerializeFrames(FArchive& Ar, FPhysRecordData& Data, int FirstFrame, int NumOfFrames);
+	static void SerializeFinished(FArchive& Ar, FPhysRecordData& Data);
+private:
+	AdvPhysBakeWorkerProtocol() {}
+
+	static bool ReceiveBytes(FSocket* Socket, uint8* Data, int32 Size, const TAtomic<bool>* bCancel, double Deadline);
+};
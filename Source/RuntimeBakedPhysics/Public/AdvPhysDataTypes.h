@@ -2,7 +2,7 @@
 #include "GeometryCollection/GeometryCollectionComponent.h"
 #include "AdvPhysDataTypes.generated.h"
 
-class AAdvPhysEventBase;
+class AAdvPhysEvent_ForceField;
 
 UENUM()
 enum EShapeType
@@ -12,16 +12,91 @@ enum EShapeType
 	TriMesh
 };
 
+UENUM()
+enum EPhysBroadphaseType
+{
+	SweepAndPrune,
+	// Needs WorldBounds of the profile to cover the scene
+	MultiBoxPruning
+};
+
+// PhysX settings of the scenes and bodies a bake is recorded with
+USTRUCT(BlueprintType)
+struct FPhysBakeProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere)
+	TEnumAsByte<EPhysBroadphaseType> Broadphase = SweepAndPrune;
+
+	// Split into MBPSubdivisions x MBPSubdivisions broadphase regions on the XY plane
+	UPROPERTY(EditAnywhere)
+	FBox WorldBounds = FBox(FVector(-100000.0f), FVector(100000.0f));
+
+	UPROPERTY(EditAnywhere)
+	int MBPSubdivisions = 4;
+
+	// Persistent contact manifolds
+	UPROPERTY(EditAnywhere)
+	bool bEnablePCM = true;
+
+	UPROPERTY(EditAnywhere)
+	bool bEnableStabilization = false;
+
+	UPROPERTY(EditAnywhere)
+	bool bEnableCCD = false;
+
+	UPROPERTY(EditAnywhere)
+	int PositionIterations = 4;
+
+	UPROPERTY(EditAnywhere)
+	int VelocityIterations = 1;
+
+	// Mass-normalized kinetic energy below which bodies may sleep, < 0 keeps the PhysX default
+	UPROPERTY(EditAnywhere)
+	float SleepThreshold = -1.0f;
+
+	// Stream recordings to the PhysX Visual Debugger
+	UPROPERTY(EditAnywhere)
+	bool bConnectPvd = false;
+
+	UPROPERTY(EditAnywhere)
+	FString PvdHost = TEXT("localhost");
+
+	UPROPERTY(EditAnywhere)
+	int PvdPort = 5425;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysBakeProfile& Profile)
+	{
+		uint8 Broadphase = Profile.Broadphase;
+		Ar << Broadphase;
+		Profile.Broadphase = static_cast<EPhysBroadphaseType>(Broadphase);
+		Ar << Profile.WorldBounds << Profile.MBPSubdivisions;
+		Ar << Profile.bEnablePCM << Profile.bEnableStabilization << Profile.bEnableCCD;
+		Ar << Profile.PositionIterations << Profile.VelocityIterations << Profile.SleepThreshold;
+		Ar << Profile.bConnectPvd << Profile.PvdHost << Profile.PvdPort;
+		return Ar;
+	}
+};
+
 struct FPhysObject
 {
 	explicit FPhysObject(UStaticMeshComponent* Comp) :
 		Comp(Comp),
+		Id(GetStableId(Comp)),
 		CollisionProfile(Comp->GetCollisionProfileName()),
 		Location(Comp->GetComponentLocation()),
 		Rotation(Comp->GetComponentRotation())
 	{ }
+
+	// Owner and component name, which stay the same across loads of a level unlike the order objects are added in
+	static FName GetStableId(const UActorComponent* Comp)
+	{
+		return FName(Comp->GetOwner()->GetFName().ToString() + TEXT(".") + Comp->GetFName().ToString());
+	}
 	
 	UStaticMeshComponent* Comp;
+	FName Id;
 	FName CollisionProfile;
 	FVector Location;
 	FRotator Rotation;
@@ -36,23 +111,71 @@ struct FPhysGeomCollection
 	UGeometryCollectionComponent* Comp;
 };
 
-struct FPhysEventNode
+struct FPhysForceFieldEntry
 {
-	AAdvPhysEventBase* EventActor;
-	std::shared_ptr<FPhysEventNode> Next;
+	AAdvPhysEvent_ForceField* Field;
+	int StartFrame;
+	int EndFrame;
 };
 
 struct FPhysObjLocRot
 {
 	FVector Location;
 	FRotator Rotation;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysObjLocRot& LocRot)
+	{
+		return Ar << LocRot.Location << LocRot.Rotation;
+	}
 };
 
 struct FPhysObjSODData
 {
 	FBox Bounds;
-	uint32 StartHash;
-	uint32 EndHash;
+	uint64 StartHash;
+	uint64 EndHash;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysObjSODData& SODData)
+	{
+		return Ar << SODData.Bounds << SODData.StartHash << SODData.EndHash;
+	}
+};
+
+// Contact between two bodies during a recorded frame, in bake space
+struct FPhysImpactEvent
+{
+	int Frame;
+	// Bake object indices, INDEX_NONE for static geometry
+	int ObjA;
+	int ObjB;
+	FVector3f Location;
+	float Impulse;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysImpactEvent& Impact)
+	{
+		return Ar << Impact.Frame << Impact.ObjA << Impact.ObjB << Impact.Location << Impact.Impulse;
+	}
+};
+
+// Cost and activity of one recorded frame
+struct FPhysFrameTelemetry
+{
+	// Seconds spent in simulate and fetchResults over all substeps
+	float SimulateTime;
+	int AwakeBodies;
+	// Shape pairs touching, and shape pairs the narrowphase processed, after the last substep
+	int ContactPairs;
+	int NarrowphasePairs;
+	// Shape pairs with overlapping bounds after the last substep, counted from the pairs found and lost in every substep
+	int BroadphasePairs;
+	// Events fired at the start of the frame
+	int Events;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysFrameTelemetry& Telemetry)
+	{
+		return Ar << Telemetry.SimulateTime << Telemetry.AwakeBodies << Telemetry.ContactPairs << Telemetry.NarrowphasePairs
+			<< Telemetry.BroadphasePairs << Telemetry.Events;
+	}
 };
 
 USTRUCT(BlueprintType)
@@ -72,9 +195,16 @@ struct FPhysRecordData
 	UPROPERTY(BlueprintReadOnly)
 	float FrameInterval;
 
+	UPROPERTY(BlueprintReadOnly)
+	int ObjectCount;
+
 	UPROPERTY(BlueprintReadOnly)
 	bool bEnableSOD;
 
+	// Transform of the recording scene, playback is relative to it
+	UPROPERTY(BlueprintReadOnly)
+	FTransform Origin;
+
 	UPROPERTY(BlueprintReadOnly)
 	FVector HashWorldCenter;
 
@@ -83,4 +213,110 @@ struct FPhysRecordData
 	
 	TArray<FPhysObjLocRot> ObjLocRot;
 	TArray<FPhysObjSODData> ObjSOD;
-};
\ No newline at end of file
+
+	// Per frame MinX, MinY, MinZ, MaxX, MaxY, MaxZ planes of SODSoAStride floats each, for AdvPhysSODKernel
+	int SODSoAStride;
+	TArray<float> ObjSODSoA;
+
+	// FPhysObject::Id of every dynamic object in bake order
+	TArray<FName> ObjectIds;
+
+	// Impacts by frame, in Morton order of their location within a frame.
+	// Impacts of frame i are Impacts[ImpactFrameStarts[i]] up to Impacts[ImpactFrameStarts[i + 1]], empty if none were recorded.
+	TArray<FPhysImpactEvent> Impacts;
+	TArray<int> ImpactFrameStarts;
+
+	bool HasImpacts() const
+	{
+		return ImpactFrameStarts.Num() == FrameCount + 1;
+	}
+
+	// Contact island of every object per frame, as the lowest object index in it. Empty if not recorded.
+	TArray<int> ObjIsland;
+
+	// One entry per frame if recorded with telemetry, empty otherwise
+	TArray<FPhysFrameTelemetry> Telemetry;
+
+	// Hash of the poses of all objects per frame, to tell identical bakes apart quickly. Empty if not recorded.
+	TArray<uint64> FrameHashes;
+
+	// CRC of the tracks, set once the bake finishes or loads so replicas can tell they play the same one
+	uint32 Checksum = 0;
+
+	void UpdateChecksum()
+	{
+		Checksum = FCrc::MemCrc32(ObjLocRot.GetData(), ObjLocRot.Num() * sizeof(FPhysObjLocRot));
+		Checksum = FCrc::MemCrc32(&FrameInterval, sizeof(FrameInterval), Checksum);
+	}
+
+	// Heap bytes held by the tracks and their caches
+	SIZE_T GetAllocatedSize() const
+	{
+		return sizeof(FPhysRecordData)
+			+ ObjLocRot.GetAllocatedSize()
+			+ ObjSOD.GetAllocatedSize()
+			+ ObjSODSoA.GetAllocatedSize()
+			+ ObjectIds.GetAllocatedSize()
+			+ Impacts.GetAllocatedSize()
+			+ ImpactFrameStarts.GetAllocatedSize()
+			+ ObjIsland.GetAllocatedSize()
+			+ Telemetry.GetAllocatedSize()
+			+ FrameHashes.GetAllocatedSize();
+	}
+
+	// Payload of finished bakes, as stored in bake assets
+	friend FArchive& operator<<(FArchive& Ar, FPhysRecordData& Data)
+	{
+		int Version = 6;
+		Ar << Version;
+		Ar << Data.FrameCount << Data.FrameInterval << Data.ObjectCount << Data.bEnableSOD;
+		Ar << Data.Origin << Data.HashWorldCenter << Data.HashCellSize;
+		Ar << Data.ObjectIds;
+		Ar << Data.ObjLocRot;
+		Ar << Data.ObjSOD;
+		Ar << Data.SODSoAStride;
+		Data.ObjSODSoA.BulkSerialize(Ar);
+		if (Version >= 2)
+		{
+			Ar << Data.Impacts << Data.ImpactFrameStarts;
+		}
+		if (Version >= 3)
+		{
+			Data.ObjIsland.BulkSerialize(Ar);
+		}
+		if (Version >= 6)
+		{
+			Ar << Data.Telemetry;
+		}
+		else if (Version >= 4)
+		{
+			// Telemetry without broadphase pairs, only ever loaded
+			int32 NumOfFrames = 0;
+			Ar << NumOfFrames;
+			if (NumOfFrames < 0 || NumOfFrames > Data.FrameCount)
+			{
+				Ar.SetError();
+				return Ar;
+			}
+			Data.Telemetry.SetNumZeroed(NumOfFrames);
+			for (auto& Frame : Data.Telemetry)
+			{
+				Ar << Frame.SimulateTime << Frame.AwakeBodies << Frame.ContactPairs << Frame.NarrowphasePairs << Frame.Events;
+			}
+		}
+		if (Version >= 5)
+		{
+			Data.FrameHashes.BulkSerialize(Ar);
+		}
+		if (Ar.IsLoading())
+		{
+			Data.UpdateChecksum();
+			Data.Finished = true;
+			Data.Progress = 1.0f;
+		}
+		return Ar;
+	}
+};
+
+// Bakes are immutable once recorded and may be shared by several playing scenes
+typedef TSharedPtr<FPhysRecordData, ESPMode::ThreadSafe> FPhysRecordDataPtr;
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include "CoreMinimal.h"
 #include "AdvPhysDataTypes.h"
+#include "AdvPhysSceneDesc.h"
 #include "GameFramework/Actor.h"
 #include "AdvPhysEventBase.generated.h"
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPlay);
@@ -30,6 +31,10 @@ public:
 	
 	UPROPERTY(EditAnywhere)
 	float Time;
+
+	// Class, transform and editable properties, for baking the event outside of this world
+	void ExportDesc(FPhysEventDesc& OutDesc) const;
+	static AAdvPhysEventBase* SpawnFromDesc(UWorld* World, const FPhysEventDesc& Desc);
 	
 protected:
 	// Called when the game starts or when spawned
@@ -38,8 +43,12 @@ protected:
 	void BroadcastOnPlay();
 	void BroadcastOnTrigger();
 
+	// Sphere outside of which the event has no effect, used to query candidate bodies. False affects every body.
+	virtual bool GetInfluenceSphere(FVector& OutCenter, float& OutRadius) const;
+
+	// Bodies are the candidates found within the influence sphere
 	virtual void DoEventPhysX(std::vector<physx::PxRigidDynamic*>& Bodies);
-	virtual void DoEventUE(TArray<FPhysObject>& Dynamics);
+	virtual void DoEventUE(TArrayView<const FPhysObject> Dynamics);
 	
 	friend class AAdvPhysScene;
 	friend class PhysSimulator;
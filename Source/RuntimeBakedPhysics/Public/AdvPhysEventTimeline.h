@@ -0,0 +1,33 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class AAdvPhysEventBase;
+
+struct FPhysTimelineEntry
+{
+	float Time;
+	// Recorded frame the event is handled at, INDEX_NONE without a bake
+	int Frame;
+	bool bIsContinuous;
+	AAdvPhysEventBase* EventActor;
+};
+
+// Events sorted by time, built once and shared read-only by the bake thread and playback
+class RUNTIMEBAKEDPHYSICS_API FPhysEventTimeline
+{
+public:
+	FPhysEventTimeline(const TArray<AAdvPhysEventBase*>& EventActors, float Interval, int FrameCount);
+
+	// Index of the first entry after Time, so every entry before it has triggered by Time
+	int Seek(float Time) const;
+	// Index of the first entry handled at or after Frame
+	int SeekFrame(int Frame) const;
+
+	int Num() const { return Entries.Num(); }
+	const FPhysTimelineEntry& operator[](int Index) const { return Entries[Index]; }
+
+private:
+	TArray<FPhysTimelineEntry> Entries;
+};
+
+typedef TSharedPtr<const FPhysEventTimeline, ESPMode::ThreadSafe> FPhysEventTimelinePtr;
@@ -24,6 +24,7 @@ public:
 		float FallOffMaxDistance;
 
 protected:
+	virtual bool GetInfluenceSphere(FVector& OutCenter, float& OutRadius) const override;
 	virtual void DoEventPhysX(std::vector<physx::PxRigidDynamic*>& Bodies) override;
-	virtual void DoEventUE(TArray<FPhysObject>& Dynamics) override;
+	virtual void DoEventUE(TArrayView<const FPhysObject> Dynamics) override;
 };
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AdvPhysDataTypes.h"
+#include "AdvPhysEventBase.h"
+#include "AdvPhysEvent_ForceField.generated.h"
+
+UENUM()
+enum EForceFieldType
+{
+	Wind,
+	Vortex,
+	RadialPull,
+	DirectionalGust
+};
+
+/**
+ * Continuous event applied on every recorded step from Time to Time + Duration.
+ * Forces are evaluated for all affected bodies in one batched call.
+ */
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API AAdvPhysEvent_ForceField : public AAdvPhysEventBase
+{
+	GENERATED_BODY()
+	
+public:
+
+	AAdvPhysEvent_ForceField();
+
+	UPROPERTY(EditAnywhere)
+		TEnumAsByte<EForceFieldType> FieldType;
+	UPROPERTY(EditAnywhere)
+		float Duration;
+	UPROPERTY(EditAnywhere)
+		float Strength;
+	// Bodies further than this are unaffected, <= 0 affects the whole scene
+	UPROPERTY(EditAnywhere)
+		float Radius;
+	// Wind and gust direction, vortex axis. Local to the actor.
+	UPROPERTY(EditAnywhere)
+		FVector Direction;
+	UPROPERTY(EditAnywhere)
+		float GustFrequency;
+	// Apply as acceleration so light and heavy bodies move alike
+	UPROPERTY(EditAnywhere)
+		bool bIgnoreMass;
+
+	// Writes the force on each body at FieldTime seconds into the field. Arrays are padded to a multiple of 4.
+	void ComputeForces(const float* PosX, const float* PosY, const float* PosZ, int Count, float FieldTime,
+		float* OutX, float* OutY, float* OutZ) const;
+
+protected:
+	virtual bool GetInfluenceSphere(FVector& OutCenter, float& OutRadius) const override;
+};
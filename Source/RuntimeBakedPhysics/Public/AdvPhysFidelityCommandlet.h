@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AdvPhysFidelityCommandlet.generated.h"
+
+// Records a high-rate reference bake of a scene, then measures the position and rotation error PlayFrame shows
+// for bakes at lower rates, with and without interpolation, against their memory. Writes one CSV row per configuration.
+// -run=AdvPhysFidelity [-scene=Path.apsf | -counts=200] [-shape=box|sphere|convex|mixed] [-duration=5]
+//   [-reference=0.004166] [-intervals=0.0166,0.0333,0.0666] [-substeps=1,2] [-threads=N] [-out=Path.csv]
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysFidelityCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAdvPhysFidelityCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -1,20 +1,40 @@
 ﻿#pragma once
 #include <PxBounds3.h>
 
-#define WORLD_CELL_LENGTH 1625
+#include "PhysHashCore.h"
 
 class AdvPhysHashHelper
 {
 public:
-	static void GetHash(physx::PxBounds3 Bounds, FVector WorldCenter, float CellSize, uint32& Start, uint32& End);
-	static void GetHash(FBox Bounds, FVector WorldCenter, float CellSize, uint32& Start, uint32& End);
+	static void GetHash(physx::PxBounds3 Bounds, FVector WorldCenter, float CellSize, uint64& Start, uint64& End);
+	static void GetHash(FBox Bounds, FVector WorldCenter, float CellSize, uint64& Start, uint64& End);
 	
-	static uint32 GetHash(physx::PxVec3 Point, FVector WorldCenter, float CellSize);
-	static uint32 GetHash(FVector Point, FVector WorldCenter, float CellSize);
+	static uint64 GetHash(physx::PxVec3 Point, FVector WorldCenter, float CellSize);
+	static uint64 GetHash(FVector Point, FVector WorldCenter, float CellSize);
 	
-	static void SplitFromHash(uint32 Hash, unsigned& X, unsigned& Y, unsigned& Z);
-	static int32 JoinToHash(unsigned X, unsigned Y, unsigned Z);
-	static void CubicSweepHash(uint32 Start, uint32 End, std::function<void(uint32)> Action);	
+	static void SplitFromHash(uint64 Hash, unsigned& X, unsigned& Y, unsigned& Z);
+	static uint64 JoinToHash(unsigned X, unsigned Y, unsigned Z);
+	static FVector GetCellWorldStart(FVector WorldCenter, float CellSize);
+
+	// Coarse cells are 2^CoarseShift fine cells wide on each axis
+	static uint64 ToCoarseHash(uint64 Hash, unsigned CoarseShift);
+	static unsigned GetMaxCellSpan(uint64 Start, uint64 End);
+	
+	template <typename FuncType>
+	static void CubicSweepHash(uint64 Start, uint64 End, FuncType&& Action);
 private:
 	AdvPhysHashHelper() {}
-};
\ No newline at end of file
+};
+
+template <typename FuncType>
+void AdvPhysHashHelper::CubicSweepHash(const uint64 Start, const uint64 End, FuncType&& Action)
+{
+	const uint64 Level = Start & COARSE_HASH_FLAG;
+	unsigned MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+	SplitFromHash(Start, MinX, MinY, MinZ);
+	SplitFromHash(End, MaxX, MaxY, MaxZ);
+	for (unsigned X = MinX; X <= MaxX; X++)
+		for (unsigned Y = MinY; Y <= MaxY; Y++)
+			for (unsigned Z = MinZ; Z <= MaxZ; Z++)
+				Action(JoinToHash(X, Y, Z) | Level);
+}
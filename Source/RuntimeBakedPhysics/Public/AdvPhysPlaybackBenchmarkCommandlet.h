@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AdvPhysPlaybackBenchmarkCommandlet.generated.h"
+
+// Times playback interpolation, naive and hashed SOD detection and the hash helpers on synthetic bakes.
+// -run=AdvPhysPlaybackBenchmark [-objects=1000,10000] [-activators=1,16] [-motion=rest|fall|scatter]
+//   [-frames=300] [-iterations=200] [-cellsize=100] [-seed=1] [-out=Path.csv]
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysPlaybackBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAdvPhysPlaybackBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
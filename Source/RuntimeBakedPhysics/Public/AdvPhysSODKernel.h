@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreMinimal.h"
+
+#define SOD_KERNEL_WIDTH 4
+#define SOD_SOA_PLANES 6
+
+class AdvPhysSODKernel
+{
+public:
+	// Number of floats in each SoA plane, padded to the kernel width
+	static int GetStride(int NumOfObjects);
+	// Fills the padding lanes of a frame so they never overlap anything
+	static void ResetPadding(float* FrameSoA, int NumOfObjects, int Stride);
+	static void WriteBounds(float* FrameSoA, int Stride, int ObjIndex, const FVector& Min, const FVector& Max);
+
+	// Tests every object bounds of a frame against all activator boxes, SOD_KERNEL_WIDTH objects at a time.
+	// Bit (i % 32) of OutMask[i / 32] is set if object i overlaps any of the boxes.
+	static void OverlapActivators(const float* FrameSoA, int Stride, const TArray<FBox>& Activators, TArray<uint32>& OutMask);
+private:
+	AdvPhysSODKernel() {}
+};
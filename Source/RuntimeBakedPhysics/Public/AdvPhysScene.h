@@ -3,11 +3,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "AdvPhysBakeWorkerClient.h"
 #include "AdvPhysDataTypes.h"
 #include "AdvPhysEventBase.h"
+#include "AdvPhysEventTimeline.h"
 #include "PhysSimulator.h"
 #include "GameFramework/Actor.h"
-#include <hash_map>
+#include "Async/Async.h"
+#include <unordered_map>
 
 #include "AdvPhysSceneController.h"
 #include "AdvPhysScene.generated.h"
@@ -22,19 +25,117 @@ enum EAction
 	PlayingRealtimeSimulation
 };
 
+struct FSODActivator
+{
+	USceneComponent* Comp;
+	float AddedTime;
+};
+
+// Scratch state of one SOD detection pass, owned by the background task while it runs
+struct FSODWorkspace
+{
+	TArray<FBox> ActivatorBounds;
+	TArray<bool> ActivationState;
+	TArray<int> Activated;
+	TArray<uint32> SODActivationMask;
+	std::unordered_map<uint64, std::vector<int>> SODMap;
+	std::unordered_map<uint64, std::vector<int>> ActivatorMap;
+};
+
+// Re-simulated tracks replacing the bake of some objects for a range of frames
+struct FTrackOverride
+{
+	int StartFrame;
+	int FrameCount;
+	// Bake object indices, in the order of Data's objects
+	TArray<int> ObjIndices;
+	// Already in play space
+	FPhysRecordDataPtr Data;
+};
+
 struct FStatus
 {
 	EAction Current;
 	float PlayStartTime;
+	// Position in the bake, advanced by PlaybackRate every tick
+	float PlayTime;
+	// From the space the bake was recorded in to the space it is played in
+	FTransform PlayTransform;
+	FTransform InversePlayTransform;
+	bool bRelocated;
 	float LastPlayFrameTime;
 	float LastSODCheckTime;
-	TArray<AAdvPhysEventBase*> PlayEventActors;
+	int EventCursor;
+	// Next bake frame whose impacts are dispatched
+	int ImpactFrameCursor;
 	TArray<bool> SODActivationState;
-	TArray<USceneComponent*> AddedActivators;
-	std::hash_map<uint32, std::list<int>> SODMap;
+	TArray<FSODActivator> AddedActivators;
+	TSet<USceneComponent*> AddedActivatorSet;
+	// Expanded activator boxes of the current SOD check, overlapping added activators merged
+	TArray<FBox> ActivatorBounds;
+	TSharedPtr<FSODWorkspace, ESPMode::ThreadSafe> SODWorkspace;
+	TFuture<int> SODTask;
+	
+	TSparseArray<FTrackOverride> TrackOverrides;
+	// Index into TrackOverrides per object, INDEX_NONE for baked ones, and the object's track in it
+	TArray<int> OverrideSlots;
+	TArray<int> OverrideTracks;
+	// Objects and first bake frame of the local re-bake in flight
+	bool bRebakePending;
+	int RebakeStartFrame;
+	TArray<int> RebakeObjects;
+	// Replicated activations already applied on a client
+	int ReplicatedActivationCursor;
+	// Recording is done by a bake worker rather than Simulator
+	bool bRecordingInWorker;
+};
+
+// Everything a client needs to play the same bake in sync with the server
+USTRUCT()
+struct FAdvPhysReplicatedPlayback
+{
+	GENERATED_BODY()
+
+	// Clients only follow a bake identical to their own
+	UPROPERTY()
+	uint32 BakeChecksum = 0;
+
+	UPROPERTY()
+	bool bPlaying = false;
+
+	// Server time at which playback was at AnchorPlayTime, advancing Rate bake seconds per second since
+	UPROPERTY()
+	double AnchorServerTime = 0.0;
+
+	UPROPERTY()
+	float AnchorPlayTime = 0.0f;
+
+	UPROPERTY()
+	float Rate = 1.0f;
+
+	// Bumped when playback restarts or seeks, clients then start over from the anchor
+	UPROPERTY()
+	uint8 PlayCount = 0;
+};
+
+USTRUCT()
+struct FAdvPhysReplicatedActivation
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 ObjIndex = 0;
+
+	UPROPERTY()
+	int32 Frame = 0;
 };
 
 DECLARE_MULTICAST_DELEGATE(FRecordFinishedDeleagte)
+DECLARE_MULTICAST_DELEGATE(FBakeLoadedDelegate)
+DECLARE_MULTICAST_DELEGATE_OneParam(FImpactPlayedDelegate, const FPhysImpactEvent&)
+
+class UAdvPhysBakeAsset;
+class UAdvPhysBakeProfile;
 
 UCLASS()
 class RUNTIMEBAKEDPHYSICS_API AAdvPhysScene : public AActor
@@ -53,6 +154,25 @@ public:
 		void ClearPhysObjects();
 	
 	void Record(const float Interval, const int FrameCount);
+
+	// Writes what Record would bake as an engine-neutral scene file, for baking outside of Unreal with Tools/AdvPhysBake
+	UFUNCTION(BlueprintCallable)
+		bool ExportSceneFile(const FString& Path, float Interval, int FrameCount);
+
+	// Writes the per-frame telemetry of the bake as CSV, if it was recorded with bRecordTelemetry
+	UFUNCTION(BlueprintCallable)
+		bool ExportTelemetry(const FString& Path);
+
+	// Stores the finished bake of this scene in the asset, to be referenced by BakeAsset instead of recording at runtime
+	UFUNCTION(BlueprintCallable)
+		void SaveBakeToAsset(UAdvPhysBakeAsset* Asset);
+
+#if WITH_EDITOR
+	// Splits the bake of BakeAsset into one scene per PartitionCellSize grid cell, each embedding the tracks
+	// of the dynamic actors inside it so World Partition streams bake and objects in and out together
+	UFUNCTION(CallInEditor)
+		void PartitionBakeByCell();
+#endif
 	
 	UFUNCTION(BlueprintCallable)
 		void Play();
@@ -60,6 +180,18 @@ public:
 		void PlayRealtimeSimulation();
 	UFUNCTION(BlueprintCallable)
 		void Cancel();
+
+	// Places every object at Time in the bake, starting playback if needed.
+	// Events before Time count as triggered and SOD-activated objects return to baked playback.
+	UFUNCTION(BlueprintCallable)
+		void Seek(float Time);
+	// Bake seconds per world second, negative plays in reverse and 0 pauses for scrubbing
+	UFUNCTION(BlueprintCallable)
+		void SetPlaybackRate(float Rate);
+	UFUNCTION(BlueprintCallable)
+		float GetPlaybackRate() const;
+	UFUNCTION(BlueprintCallable)
+		float GetPlayTime() const;
 	
 	UFUNCTION(BlueprintCallable)
 		void FreezeDynamicObjects();
@@ -93,6 +225,26 @@ public:
 	UFUNCTION(BlueprintCallable)
 		bool GetRecordDataFinished() const;
 
+	// Bytes held by the bake of this scene, see UAdvPhysBakeCacheSubsystem
+	UFUNCTION(BlueprintCallable)
+		int64 GetBakeMemorySize() const;
+
+	// Part of GetBakeMemorySize the serialized payload of the bake asset keeps resident, eviction does not free it
+	int64 GetBakePayloadSize() const;
+
+	UFUNCTION(BlueprintCallable)
+		bool IsBakeEvicted() const;
+
+	// Starts reloading an evicted bake ahead of Play(), which otherwise waits for the reload itself
+	UFUNCTION(BlueprintCallable)
+		void PrefetchBake();
+
+	bool CanEvictBake() const;
+	// Releases the bake, writing it to Saved/ first unless it can be read again from its asset
+	void EvictBake();
+	// Same for every scene playing the same bake
+	const void* GetBakeIdentity() const;
+
 	UFUNCTION(BlueprintCallable)
 		bool GetEnableSOD() const;
 
@@ -104,9 +256,39 @@ public:
 
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	UPROPERTY(EditAnywhere)
 	float PlayFramesPerSecond = -1;
 	
+	// Loaded asynchronously on BeginPlay and bound to the dynamic objects by id, replacing Record()
+	UPROPERTY(EditAnywhere)
+	TSoftObjectPtr<UAdvPhysBakeAsset> BakeAsset;
+
+	// Play the bake of another scene instead of this one's, placed relative to this actor.
+	// Dynamic objects must be added in the same order as the source's.
+	UPROPERTY(EditAnywhere)
+	AAdvPhysScene* BakeSource = nullptr;
+
+	// Bake seconds playback starts at
+	UPROPERTY(EditAnywhere)
+	float PlayTimeOffset = 0.0f;
+
+	// SOD checks only run while this is positive, activated objects keep simulating at world speed
+	UPROPERTY(EditAnywhere)
+	float PlaybackRate = 1.0f;
+	
+	// Scenes of a group share one playback clock, a scene streaming in while its group plays joins at the group's time
+	UPROPERTY(EditAnywhere)
+	FName PlaybackGroup;
+
+	UPROPERTY(EditAnywhere)
+	float PartitionCellSize = 12800.0f;
+
+	// Added as dynamic objects on BeginPlay. Referencing them keeps them in the streaming cell of this scene.
+	UPROPERTY(EditAnywhere)
+	TArray<AActor*> DynamicActors;
+	
 	UPROPERTY(EditAnywhere)
 	bool bEnableInterpolation = true;
 	
@@ -127,10 +309,44 @@ public:
 
 	UPROPERTY(EditAnywhere)
 	TArray<AAdvPhysEventBase*> EventActors;
+
+	// Record contacts so playback can fire impact effects without detecting collisions
+	UPROPERTY(EditAnywhere)
+	bool bRecordImpacts = false;
+
+	UPROPERTY(EditAnywhere)
+	float ImpactImpulseThreshold = 1000.0f;
+
+	// Record simulate time, awake bodies, contact pairs and events of every frame into the bake
+	UPROPERTY(EditAnywhere)
+	bool bRecordTelemetry = false;
+
+	// Record a hash of every frame's poses, for comparing bakes with -run=AdvPhysBakeCompare
+	UPROPERTY(EditAnywhere)
+	bool bRecordStateHashes = false;
+
+	// Bake with PhysX settings pinned for reproducible results, at some cost in speed
+	UPROPERTY(EditAnywhere)
+	bool bDeterministicBake = false;
+
+	// PhysX settings to bake with, PhysX defaults if none
+	UPROPERTY(EditAnywhere)
+	UAdvPhysBakeProfile* BakeProfile = nullptr;
+
+	// Impacts farther than this from the player's view are not dispatched, <= 0 dispatches all
+	UPROPERTY(EditAnywhere)
+	float ImpactCullDistance = -1.0f;
 	
 	UPROPERTY(EditAnywhere)
 	AAdvPhysSceneController* Controller;
 
+	// Record in a worker run with -run=AdvPhysBakeWorker instead of this process. Controllers do not take part.
+	UPROPERTY(EditAnywhere)
+	bool bBakeInWorker = false;
+
+	UPROPERTY(EditAnywhere)
+	FString BakeWorkerAddress = TEXT("127.0.0.1:7781");
+
 	UPROPERTY(EditAnywhere)
 	bool bEnableSOD = false;
 	
@@ -140,19 +356,66 @@ public:
 	UPROPERTY(EditAnywhere)
 	float SODCheckFramesPerSecond = -1;
 
+	// Objects and activators spanning more hash cells than this on any axis go to the coarse level, 0 disables the hierarchy
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0", ClampMax = "2097152"))
+	int SODHierarchyMaxCellSpan = 8;
+
+	// Coarse cells are 2^SODHierarchyCoarseShift hash cells wide
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1", ClampMax = "20"))
+	int SODHierarchyCoarseShift = 3;
+
 	UPROPERTY(EditAnywhere)
 	double SODOriginalActivatorBoundExpansion = 50;
 
 	UPROPERTY(EditAnywhere)
 	double SODAddedActivatorBoundExpansion = 0;
-	
+
+	// Seconds an added activator stays alive, <= 0 keeps it until its object settles
+	UPROPERTY(EditAnywhere)
+	float SODAddedActivatorLifetime = 5.0f;
+
+	// Oldest added activators are retired beyond this count, <= 0 for no limit
+	UPROPERTY(EditAnywhere)
+	int SODMaxAddedActivators = 256;
 
 	UPROPERTY(EditAnywhere)
 	bool bUseNaiveSODCheck = false;
+
+	// Run SOD detection on a worker task, its result is applied at the start of the next tick
+	UPROPERTY(EditAnywhere)
+	bool bAsyncSODCheck = false;
 	
 	UPROPERTY(EditAnywhere)
 	bool bEnableSODChainReaction = false;
 
+	// Record contact islands and activate every object resting on an activated one in the same step
+	UPROPERTY(EditAnywhere)
+	bool bSODActivateIslands = false;
+
+	// Replicate bake playback as a clock and SOD activations instead of object transforms.
+	// Clients play their own copy of the bake and do not run SOD checks themselves.
+	UPROPERTY(EditAnywhere)
+	bool bReplicateBakedPlayback = false;
+
+	// Re-simulate baked objects around activated ones in the background and play them from the new tracks.
+	// Ignored when bReplicateBakedPlayback is on.
+	UPROPERTY(EditAnywhere)
+	bool bSODLocalRebake = false;
+
+	// Distance from activated objects' bounds within which baked objects are re-simulated
+	UPROPERTY(EditAnywhere)
+	float LocalRebakeRadius = 300.0f;
+
+	UPROPERTY(EditAnywhere)
+	float LocalRebakeSeconds = 2.0f;
+
+	UPROPERTY(EditAnywhere)
+	int LocalRebakeMaxObjects = 128;
+
+	// Objects ending a re-baked track farther than this from their bake are activated instead of returning to it
+	UPROPERTY(EditAnywhere)
+	float LocalRebakeReturnTolerance = 5.0f;
+
 	UPROPERTY(EditAnywhere)
 	bool bDrawSODObjectBoundsOnPlay = false;
 
@@ -162,6 +425,13 @@ public:
 	UPROPERTY(EditAnywhere)
 	bool bDrawSODActivatedObjectsOnPlay = false;
 
+	// Graph of the bake's telemetry above the scene, simulate time in red and awake bodies in green
+	UPROPERTY(EditAnywhere)
+	bool bDrawTelemetryGraphOnPlay = false;
+
+	UPROPERTY(EditAnywhere)
+	FVector2D TelemetryGraphSize = FVector2D(1000.0f, 300.0f);
+
 	UPROPERTY(EditAnywhere)
 	bool bUseSimpleGeometryForDynamicObj = false;
 	
@@ -170,46 +440,135 @@ public:
 
 	TArray<FPhysObject> DynamicObjEntries;
 	TArray<FPhysObject> StaticObjEntries;
+	TMap<const UPrimitiveComponent*, int> DynamicObjIndices;
 	
 	FRecordFinishedDeleagte RecordFinished;
+	FBakeLoadedDelegate BakeLoaded;
+	// Impacts of baked playback, located in play space
+	FImpactPlayedDelegate ImpactPlayed;
 
 protected:
+	// Drive the playback and SOD paths below on bakes made outside of a level
+	friend class UAdvPhysPlaybackBenchmarkCommandlet;
+	friend class UAdvPhysFidelityCommandlet;
+
 	virtual void BeginPlay() override;
 
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 	inline float GetDuration() const;
 
 	void DoRecordTick();
-	void DoPlayTick();
+	void DoPlayTick(float DeltaTime);
+	void UpdateBakeBytesStat();
+	FPhysBakeProfile GetBakeProfile() const;
 	void DoPlayRealtimeSimulationTick();
 
 	void PlayFrame(float Time);
+	void ToPlaySpace(FVector& Location, FRotator& Rotation) const;
+	FBox ToBakeSpace(const FBox& Box) const;
 	void HandleEventsInFrame(float Time, bool ApplyEventsToRealWorld);
+	TArrayView<const FPhysObject> QueryEventObjects(const AAdvPhysEventBase* Event);
+	void DispatchImpacts(float Time);
 
 	void CheckSODAtTime(float Time);
-	bool CheckActivatorIntersect(const USceneComponent* Activator, const FPhysObjSODData& SODData, const bool bIsOriginal) const;
-	
-	void RebuildSODMap(int FrameIndex);
-	void CheckFromSODMap(const USceneComponent* Activator, const int FrameIndex, const bool bIsOriginal);
+	void ApplyAsyncSODResult(int FrameIndex);
+	void WaitForSODTask();
+	void ResetSODState();
+	void UpdateActivators();
+	bool ShouldRetireActivator(const FSODActivator& Activator, float Now) const;
+
+	void DetectSOD(const int FrameIndex, FSODWorkspace& Workspace) const;
+	void RebuildSODMap(int FrameIndex, FSODWorkspace& Workspace) const;
+	// Hierarchy settings clamped to what the hash can hold, they can still be set out of range from code
+	int GetSODMaxCellSpan() const;
+	unsigned GetSODCoarseShift() const;
+	void CheckFromSODMap(const int FrameIndex, FSODWorkspace& Workspace) const;
 	void SimulateObjectOnDemand(int ObjIndex, int FrameIndex);
+	void ActivateObject(int ObjIndex, const FPhysObjLocRot& Previous, const FPhysObjLocRot& Current, int FrameIndex);
+	void GetPlayPose(int ObjIndex, int FrameIndex, FVector& Location, FRotator& Rotation) const;
+	void StartLocalRebake(int FrameIndex, const TArray<int>& Activated);
+	void ApplyLocalRebake(int FrameIndex);
+	void RetireTrackOverrides(int FrameIndex);
+	void StopLocalRebake();
+
+	bool IsPlaybackReplica() const;
+	uint32 GetBakeChecksum() const;
+	double GetServerTime() const;
+	float GetReplicatedPlayTime() const;
+	void UpdateReplicatedPlayback(bool bRestart);
+	UFUNCTION()
+		void OnRep_Playback();
+	UFUNCTION()
+		void OnRep_Activations();
+	void ExpandToIslands(int FrameIndex, TArray<int>& Activated) const;
+	void AddActivator(USceneComponent* Comp);
 
 	void AddTaggedObjects();
+	void LoadBakeAsset();
+	void ReadBakeAsset(UAdvPhysBakeAsset* Asset);
+	void SetBakeData(FPhysRecordDataPtr Data);
+	bool BindObjectsToBake(const FPhysRecordData& Data);
+	void OnPlaybackGroupStarted(FName Group);
+	void StopPlaybackGroup();
+	void SetPlaybackGroupClock();
+	// Cancel without stopping the playback group, for restarts and bake changes of this scene alone
+	void CancelInternal();
+	void OnBakeSourceLoaded();
+	void DeleteBakeSpill();
 	void ResetPhysObjectsPosition();
 
 	void CopyObjectsToSimulator();
+	void RecordInWorker(float Interval, int FrameCount);
+	void BuildSceneDesc(float Interval, int FrameCount, FPhysSceneDesc& OutDesc);
 
 	void DrawSODObjectBounds();
 	void DrawSODHashCubes();
 	void DrawSODActivatedObjects();
+	void DrawTelemetryGraph();
 	
 
 	PhysSimulator Simulator;
+	FAdvPhysBakeWorkerClient WorkerClient;
 	FStatus Status;
 
 	UPROPERTY()
 	TArray<USceneComponent*> OriginalActivators;
+
+	// Bake of a partitioned cell, saved with this actor so it loads with the cell
+	UPROPERTY()
+	UAdvPhysBakeAsset* EmbeddedBake = nullptr;
 	
-	FPhysRecordData RecordData;
+	FPhysRecordDataPtr RecordData;
+	FPhysEventTimelinePtr EventTimeline;
+	// Objects within the influence sphere of the event being applied in realtime
+	TArray<FPhysObject> EventObjects;
+	FCollisionObjectQueryParams EventQueryParams;
 	double RecordStartTime;
+	// Bytes of the bake this scene currently counts towards STAT_AdvPhysBakeBytes
+	SIZE_T StatBakeBytes = 0;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Playback)
+	FAdvPhysReplicatedPlayback ReplicatedPlayback;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Activations)
+	TArray<FAdvPhysReplicatedActivation> ReplicatedActivations;
+
+	uint8 AppliedPlayCount = 0;
+
+	// Second simulator for local re-bakes, its destination outlives Status resets while it records
+	PhysSimulator Rebaker;
+	FPhysRecordDataPtr RebakeData;
+
+	bool bBakeEvicted = false;
+	bool bBakeReloading = false;
+	bool bPlayOnBakeReload = false;
+	// Copy of a bake recorded at runtime, written on its first eviction
+	FString BakeSpillPath;
+	// Alive until the spill is written, so a reload meanwhile reuses it
+	TWeakPtr<FPhysRecordData, ESPMode::ThreadSafe> SpillingBake;
 };
@@ -21,6 +21,7 @@ public:
 	virtual void EndRecordScene(class PhysSimulator* Sim);
 	virtual void BeginPlayScene(class AAdvPhysScene* Scene);
 	virtual void DidStartSimulateOnDemand(class AAdvPhysScene* Scene, int ObjIndex, int FrameIndex);
+	virtual void DidPlayImpact(class AAdvPhysScene* Scene, const FPhysImpactEvent& Impact);
 
 protected:
 	// Called when the game starts or when spawned
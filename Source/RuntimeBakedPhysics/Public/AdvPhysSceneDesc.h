@@ -0,0 +1,119 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "AdvPhysDataTypes.h"
+
+// Self-contained description of a scene to bake, holding everything PhysSimulator needs without the level it came from
+
+enum class EPhysShapeDescType : uint8
+{
+	Sphere,
+	Capsule,
+	Box,
+	Convex,
+	TriMesh
+};
+
+struct FPhysShapeDesc
+{
+	EPhysShapeDescType Type = EPhysShapeDescType::Sphere;
+	// Sphere radius in X, capsule radius and half height in X and Y, box half extents
+	FVector3f Params = FVector3f::ZeroVector;
+	FTransform LocalPose;
+	// Mesh scale of convex and triangle meshes
+	FVector3f Scale = FVector3f::OneVector;
+	float StaticFriction = 0.0f;
+	float DynamicFriction = 0.0f;
+	float Restitution = 0.0f;
+	// Cooked hull vertices of convex meshes, vertices and triangles of triangle meshes
+	TArray<FVector3f> Vertices;
+	TArray<uint32> Indices;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysShapeDesc& Shape)
+	{
+		Ar << Shape.Type << Shape.Params << Shape.LocalPose << Shape.Scale;
+		Ar << Shape.StaticFriction << Shape.DynamicFriction << Shape.Restitution;
+		Shape.Vertices.BulkSerialize(Ar);
+		Shape.Indices.BulkSerialize(Ar);
+		return Ar;
+	}
+};
+
+struct FPhysBodyDesc
+{
+	bool bDynamic = false;
+	FTransform Pose;
+	float Mass = 0.0f;
+	FVector3f LinearVelocity = FVector3f::ZeroVector;
+	FVector3f AngularVelocity = FVector3f::ZeroVector;
+	TArray<FPhysShapeDesc> Shapes;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysBodyDesc& Body)
+	{
+		return Ar << Body.bDynamic << Body.Pose << Body.Mass << Body.LinearVelocity << Body.AngularVelocity << Body.Shapes;
+	}
+};
+
+// Event actor to respawn, with its editable properties as text
+struct FPhysEventDesc
+{
+	FString Class;
+	FTransform Transform;
+	TArray<FString> PropertyNames;
+	TArray<FString> PropertyValues;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysEventDesc& Event)
+	{
+		return Ar << Event.Class << Event.Transform << Event.PropertyNames << Event.PropertyValues;
+	}
+};
+
+struct FPhysSceneDesc
+{
+	float FrameInterval = 0.0f;
+	int FrameCount = 0;
+	float GravityZ = 0.0f;
+
+	// Copied onto the bake as they are
+	bool bEnableSOD = false;
+	FTransform Origin;
+	FVector HashWorldCenter = FVector::ZeroVector;
+	float HashCellSize = 0.0f;
+	TArray<FName> ObjectIds;
+
+	bool bRecordImpacts = false;
+	float ImpactImpulseThreshold = 0.0f;
+	bool bRecordIslands = false;
+	FPhysBakeProfile Profile;
+	bool bRecordTelemetry = false;
+	bool bRecordStateHashes = false;
+	bool bDeterministic = false;
+
+	// Dynamic bodies first in bake order, then static ones
+	TArray<FPhysBodyDesc> Bodies;
+	TArray<FPhysEventDesc> Events;
+
+	friend FArchive& operator<<(FArchive& Ar, FPhysSceneDesc& Desc)
+	{
+		int Version = 3;
+		Ar << Version;
+		// A worker or tool older than the client cannot honour what it does not know about
+		if (Ar.IsLoading() && Version > 3)
+		{
+			Ar.SetError();
+			return Ar;
+		}
+		Ar << Desc.FrameInterval << Desc.FrameCount << Desc.GravityZ;
+		Ar << Desc.bEnableSOD << Desc.Origin << Desc.HashWorldCenter << Desc.HashCellSize << Desc.ObjectIds;
+		Ar << Desc.bRecordImpacts << Desc.ImpactImpulseThreshold << Desc.bRecordIslands;
+		if (Version >= 2)
+		{
+			Ar << Desc.Profile;
+		}
+		if (Version >= 3)
+		{
+			Ar << Desc.bRecordTelemetry << Desc.bRecordStateHashes << Desc.bDeterministic;
+		}
+		Ar << Desc.Bodies << Desc.Events;
+		return Ar;
+	}
+};
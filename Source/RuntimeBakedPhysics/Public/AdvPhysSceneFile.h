@@ -0,0 +1,27 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "AdvPhysSceneDesc.h"
+
+// FPhysSceneDesc as an engine-neutral file, read without Unreal by Tools/AdvPhysBake.
+// Little-endian; strings are a uint32 byte count and UTF-8, transforms a float3 position and float4 quaternion.
+//   "APSF" uint32 Version
+//   float FrameInterval, int32 FrameCount, float GravityZ
+//   uint8 bEnableSOD, transform Origin, double3 HashWorldCenter, float HashCellSize, uint32 N, string ObjectIds[N]
+//   uint8 bRecordImpacts, float ImpactImpulseThreshold, uint8 bRecordIslands
+//   uint8 Broadphase, double3 WorldBoundsMin, double3 WorldBoundsMax, int32 MBPSubdivisions, uint8 bEnablePCM, bEnableStabilization, bEnableCCD,
+//     int32 PositionIterations, int32 VelocityIterations, float SleepThreshold
+//   uint8 bRecordTelemetry, bRecordStateHashes, bDeterministic
+//   uint32 N, body[N]: uint8 bDynamic, transform Pose, float Mass, float3 LinearVelocity, float3 AngularVelocity, uint32 M, shape[M]
+//     shape: uint8 Type, float3 Params, transform LocalPose, float3 Scale, float StaticFriction, DynamicFriction, Restitution,
+//            uint32 V, float3 Vertices[V], uint32 I, uint32 Indices[I]
+//   uint32 N, event[N]: string Class, transform, uint32 P, (string Name, string Value)[P]
+class RUNTIMEBAKEDPHYSICS_API AdvPhysSceneFile
+{
+public:
+	static bool Save(const FString& Path, FPhysSceneDesc& Desc);
+	static bool Load(const FString& Path, FPhysSceneDesc& OutDesc);
+
+	static void Serialize(FArchive& Ar, FPhysSceneDesc& Desc);
+private:
+	AdvPhysSceneFile() {}
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Baked physics stats, shown by "stat AdvPhys" and in Insights with -trace=cpu,counters,AdvPhys
+
+DECLARE_STATS_GROUP(TEXT("AdvPhys"), STATGROUP_AdvPhys, STATCAT_Advanced);
+
+// Playback, on the game thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Play Tick"), STAT_AdvPhysPlayTick, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Play Frame"), STAT_AdvPhysPlayFrame, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SOD Check"), STAT_AdvPhysSODCheck, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SOD Rebuild Map"), STAT_AdvPhysSODRebuildMap, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SOD Simulate Object"), STAT_AdvPhysSODSimulateObject, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+
+// Recording, on the recording thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Record Simulate"), STAT_AdvPhysRecordSimulate, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Record Fetch Results"), STAT_AdvPhysRecordFetchResults, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Record Readback"), STAT_AdvPhysRecordReadback, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cooking"), STAT_AdvPhysCooking, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Objects Updated"), STAT_AdvPhysObjectsUpdated, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Objects Activated"), STAT_AdvPhysObjectsActivated, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("SOD Map Cells"), STAT_AdvPhysSODMapCells, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Bake Bytes"), STAT_AdvPhysBakeBytes, STATGROUP_AdvPhys, RUNTIMEBAKEDPHYSICS_API);
+
+UE_TRACE_CHANNEL_EXTERN(AdvPhysChannel, RUNTIMEBAKEDPHYSICS_API);
+
+TRACE_DECLARE_INT_COUNTER_EXTERN(AdvPhysObjectsUpdated);
+TRACE_DECLARE_INT_COUNTER_EXTERN(AdvPhysObjectsActivated);
+TRACE_DECLARE_INT_COUNTER_EXTERN(AdvPhysSODMapCells);
+TRACE_DECLARE_MEMORY_COUNTER_EXTERN(AdvPhysBakeBytes);
+
+// Zeroes the trace counters summed over a frame, called by the module at the start of every frame
+void ResetAdvPhysFrameCounters();
+
+// Cycle counter and Insights event on the AdvPhys channel for the rest of the scope, so not wrapped in a block
+#define ADVPHYS_SCOPE_CYCLE(Stat) \
+	SCOPE_CYCLE_COUNTER(STAT_##Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Stat, AdvPhysChannel)
+
+// Sums the amounts over a frame, in stats and in Insights alike
+#define ADVPHYS_COUNTER_ADD(Counter, Amount) \
+	do \
+	{ \
+		INC_DWORD_STAT_BY(STAT_##Counter, Amount); \
+		TRACE_COUNTER_ADD(Counter, Amount); \
+	} while (0)
+
+#define ADVPHYS_COUNTER_SET(Counter, Value) \
+	do \
+	{ \
+		SET_DWORD_STAT(STAT_##Counter, Value); \
+		TRACE_COUNTER_SET(Counter, Value); \
+	} while (0)
+
+#define ADVPHYS_MEMORY_ADD(Counter, Bytes) \
+	do \
+	{ \
+		INC_MEMORY_STAT_BY(STAT_##Counter, Bytes); \
+		TRACE_COUNTER_ADD(Counter, Bytes); \
+	} while (0)
+
+#define ADVPHYS_MEMORY_SUBTRACT(Counter, Bytes) \
+	do \
+	{ \
+		DEC_MEMORY_STAT_BY(STAT_##Counter, Bytes); \
+		TRACE_COUNTER_SUBTRACT(Counter, Bytes); \
+	} while (0)
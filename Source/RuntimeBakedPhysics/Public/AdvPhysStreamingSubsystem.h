@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AdvPhysStreamingSubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FPlaybackGroupStartedDelegate, FName)
+
+/**
+ * Shared playback clocks of scenes split across World Partition cells.
+ * Scenes of one group stream in and out on their own, the clock keeps them at the same bake time.
+ */
+UCLASS()
+class RUNTIMEBAKEDPHYSICS_API UAdvPhysStreamingSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Starts the clock of Group reading PlayTime now and advancing Rate bake seconds per second, a running clock is left as is
+	UFUNCTION(BlueprintCallable)
+		void StartGroup(FName Group, float PlayTime, float Rate = 1.0f);
+	// Moves a running clock to PlayTime and Rate, after a seek or rate change of one of its scenes
+	UFUNCTION(BlueprintCallable)
+		void SetGroupClock(FName Group, float PlayTime, float Rate);
+	// Clocks keep running while the scenes of their group are streamed out, they stop when playback finishes or is cancelled
+	UFUNCTION(BlueprintCallable)
+		void StopGroup(FName Group);
+	UFUNCTION(BlueprintCallable)
+		bool IsGroupPlaying(FName Group) const;
+
+	// Bake seconds the group is at, false if its clock is not running
+	bool GetGroupPlayTime(FName Group, float& OutPlayTime) const;
+
+	// Lets loaded scenes of the group start along with the one that started it
+	FPlaybackGroupStartedDelegate GroupStarted;
+
+private:
+	struct FGroupClock
+	{
+		// World seconds at which the group was at AnchorPlayTime
+		double AnchorWorldTime;
+		float AnchorPlayTime;
+		float Rate;
+	};
+	TMap<FName, FGroupClock> GroupClocks;
+};
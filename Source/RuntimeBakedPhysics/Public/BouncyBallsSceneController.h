@@ -18,6 +18,7 @@ public:
 	virtual void BeginRecordScene(PhysSimulator* Sim) override;
 	virtual void BeginPlayScene(AAdvPhysScene* Scene) override;
 	virtual void DidStartSimulateOnDemand(AAdvPhysScene* Scene, int ObjIndex, int FrameIndex) override;
+	virtual void DidPlayImpact(AAdvPhysScene* Scene, const FPhysImpactEvent& Impact) override;
 
 	UPROPERTY(EditAnywhere)
 	float Magnitude = 100;
@@ -32,5 +33,7 @@ public:
 	UMaterialInterface* ReplacedMaterial;
 
 private:
+	void PlayEffects(const UStaticMeshComponent* Comp);
+	
 	std::vector<UMaterialInterface*> Materials;
 };
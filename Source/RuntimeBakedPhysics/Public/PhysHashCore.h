@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Morton hashing of world cells shared by AdvPhysHashHelper and Tools/AdvPhysBake, on nothing but the standard library.
+
+// Cells per axis, 21 bits of each axis interleave into the low 63 bits of a Morton code
+#define WORLD_CELL_BITS 21
+#define WORLD_CELL_LENGTH (1u << WORLD_CELL_BITS)
+// Marks a cell of the coarse level of the hierarchy
+#define COARSE_HASH_FLAG (1ull << 63)
+
+// Distance from the hashed world center to the start of the first cell on each axis
+inline double PhysGetCellOffset(float CellSize)
+{
+	return static_cast<double>(CellSize) * WORLD_CELL_LENGTH / 2.0;
+}
+
+inline unsigned PhysToCell(double Coord, double CellWorldStart, float CellSize)
+{
+	// Clamp rather than wrap, objects beyond the hashed range share the border cells
+	const double Cell = std::floor((Coord - CellWorldStart) / CellSize);
+	return static_cast<unsigned>(std::min(std::max(Cell, 0.0), static_cast<double>(WORLD_CELL_LENGTH - 1)));
+}
+
+inline uint64_t PhysSpreadBits(unsigned Value)
+{
+	uint64_t X = Value & (WORLD_CELL_LENGTH - 1);
+	X = (X | X << 32) & 0x001f00000000ffffull;
+	X = (X | X << 16) & 0x001f0000ff0000ffull;
+	X = (X | X << 8) & 0x100f00f00f00f00full;
+	X = (X | X << 4) & 0x10c30c30c30c30c3ull;
+	X = (X | X << 2) & 0x1249249249249249ull;
+	return X;
+}
+
+inline unsigned PhysCompactBits(uint64_t Value)
+{
+	uint64_t X = Value & 0x1249249249249249ull;
+	X = (X ^ (X >> 2)) & 0x10c30c30c30c30c3ull;
+	X = (X ^ (X >> 4)) & 0x100f00f00f00f00full;
+	X = (X ^ (X >> 8)) & 0x001f0000ff0000ffull;
+	X = (X ^ (X >> 16)) & 0x001f00000000ffffull;
+	X = (X ^ (X >> 32)) & 0x00000000001fffffull;
+	return static_cast<unsigned>(X);
+}
+
+inline uint64_t PhysJoinToHash(unsigned X, unsigned Y, unsigned Z)
+{
+	return PhysSpreadBits(X) << 2 | PhysSpreadBits(Y) << 1 | PhysSpreadBits(Z);
+}
+
+// Hash of the cell containing a point, for a grid of CellSize cells centered on WorldCenter
+inline uint64_t PhysGetHash(double X, double Y, double Z, const double WorldCenter[3], float CellSize)
+{
+	const double Offset = PhysGetCellOffset(CellSize);
+	return PhysJoinToHash(
+		PhysToCell(X, WorldCenter[0] - Offset, CellSize),
+		PhysToCell(Y, WorldCenter[1] - Offset, CellSize),
+		PhysToCell(Z, WorldCenter[2] - Offset, CellSize));
+}
@@ -0,0 +1,324 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Parts of the record loop and the event kernels shared by PhysSimulator, the events and Tools/AdvPhysBake,
+// on nothing but PhysX and the standard library.
+// Include after PxPhysicsAPI.h, the game module and the tool reach PhysX through different include paths.
+
+// Filter shader data, which contact reports the scene asks PhysX for
+enum PhysContactReport : physx::PxU32
+{
+	ReportImpacts = 1 << 0,
+	ReportTouches = 1 << 1,
+	DetectCCDContacts = 1 << 2
+};
+
+// PhysX settings of a bake, FPhysBakeProfile without engine types
+struct PhysSceneSettings
+{
+	bool bMultiBoxPruning = false;
+	physx::PxBounds3 WorldBounds = physx::PxBounds3(physx::PxVec3(-100000.0f), physx::PxVec3(100000.0f));
+	int MBPSubdivisions = 4;
+	bool bEnablePCM = true;
+	bool bEnableStabilization = false;
+	bool bEnableCCD = false;
+	int PositionIterations = 4;
+	int VelocityIterations = 1;
+	// < 0 keeps the PhysX default
+	float SleepThreshold = -1.0f;
+	// Overrides CCD and stabilization, which make results depend on processing order
+	bool bDeterministic = false;
+};
+
+inline physx::PxFilterFlags PhysContactFilterShader(
+	physx::PxFilterObjectAttributes Attributes0, physx::PxFilterData FilterData0,
+	physx::PxFilterObjectAttributes Attributes1, physx::PxFilterData FilterData1,
+	physx::PxPairFlags& PairFlags, const void* ConstantBlock, physx::PxU32 ConstantBlockSize)
+{
+	using namespace physx;
+	const PxFilterFlags Flags = PxDefaultSimulationFilterShader(Attributes0, FilterData0, Attributes1, FilterData1, PairFlags, nullptr, 0);
+	if (ConstantBlockSize != sizeof(PxU32)) return Flags;
+
+	const PxU32 Report = *static_cast<const PxU32*>(ConstantBlock);
+	if (Report & ReportImpacts)
+	{
+		PairFlags |= PxPairFlag::eNOTIFY_TOUCH_FOUND | PxPairFlag::eNOTIFY_CONTACT_POINTS;
+	}
+	if (Report & ReportTouches)
+	{
+		PairFlags |= PxPairFlag::eNOTIFY_TOUCH_FOUND | PxPairFlag::eNOTIFY_TOUCH_LOST;
+	}
+	if (Report & DetectCCDContacts)
+	{
+		PairFlags |= PxPairFlag::eDETECT_CCD_CONTACT;
+	}
+	return Flags;
+}
+
+inline bool PhysUsesCCD(const PhysSceneSettings& Settings)
+{
+	return Settings.bEnableCCD && !Settings.bDeterministic;
+}
+
+inline physx::PxU32 PhysGetContactReport(bool bRecordImpacts, bool bTrackTouches, const PhysSceneSettings& Settings)
+{
+	return (bRecordImpacts ? ReportImpacts : 0)
+		| (bTrackTouches ? ReportTouches : 0)
+		| (PhysUsesCCD(Settings) ? DetectCCDContacts : 0);
+}
+
+// Everything but the dispatcher and the filter shader data
+inline void PhysApplySceneSettings(physx::PxSceneDesc& SceneDesc, const PhysSceneSettings& Settings)
+{
+	using namespace physx;
+	SceneDesc.filterShader = PhysContactFilterShader;
+	SceneDesc.broadPhaseType = Settings.bMultiBoxPruning ? PxBroadPhaseType::eMBP : PxBroadPhaseType::eSAP;
+	if (Settings.bEnablePCM) SceneDesc.flags |= PxSceneFlag::eENABLE_PCM;
+	else SceneDesc.flags &= ~PxSceneFlags(PxSceneFlag::eENABLE_PCM);
+	if (Settings.bEnableStabilization) SceneDesc.flags |= PxSceneFlag::eENABLE_STABILIZATION;
+	if (Settings.bEnableCCD) SceneDesc.flags |= PxSceneFlag::eENABLE_CCD;
+	if (Settings.bDeterministic)
+	{
+		// Results only depend on the bodies themselves, not on the order islands and pairs are processed in
+		SceneDesc.flags |= PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+		SceneDesc.flags &= ~PxSceneFlags(PxSceneFlag::eENABLE_CCD);
+		SceneDesc.flags &= ~PxSceneFlags(PxSceneFlag::eENABLE_STABILIZATION);
+	}
+}
+
+// Multi box pruning needs its regions before the first body is added
+inline void PhysAddBroadPhaseRegions(physx::PxScene* Scene, const PhysSceneSettings& Settings)
+{
+	using namespace physx;
+	if (!Settings.bMultiBoxPruning) return;
+
+	// Up axis is Z
+	PxBounds3 Regions[256];
+	const PxU32 Subdivisions = std::min(std::max(Settings.MBPSubdivisions, 1), 16);
+	const PxU32 NumOfRegions = PxBroadPhaseExt::createRegionsFromWorldBounds(Regions, Settings.WorldBounds, Subdivisions, 2);
+	for (PxU32 i = 0; i < NumOfRegions; i++)
+	{
+		PxBroadPhaseRegion Region;
+		Region.bounds = Regions[i];
+		Region.userData = nullptr;
+		Scene->addBroadPhaseRegion(Region);
+	}
+}
+
+inline void PhysApplyBodySettings(physx::PxRigidDynamic* Body, const PhysSceneSettings& Settings)
+{
+	using namespace physx;
+	Body->setSolverIterationCounts(std::min(std::max(Settings.PositionIterations, 1), 255), std::min(std::max(Settings.VelocityIterations, 0), 255));
+	if (Settings.SleepThreshold >= 0.0f) Body->setSleepThreshold(Settings.SleepThreshold);
+	if (PhysUsesCCD(Settings)) Body->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_CCD, true);
+}
+
+// Impact as reported by PhysX, observed bodies by index and static ones as -1
+struct PhysImpact
+{
+	int Frame;
+	int ObjA;
+	int ObjB;
+	physx::PxVec3 Location;
+	float Impulse;
+};
+
+// Collects impacts and touching body pairs reported by PhysX while a frame is simulated.
+// Observed bodies store their index + 1 in userData, static ones nothing.
+struct PhysContactCallback : physx::PxSimulationEventCallback
+{
+	virtual void onContact(const physx::PxContactPairHeader& PairHeader, const physx::PxContactPair* Pairs, physx::PxU32 NbPairs) override
+	{
+		using namespace physx;
+		if (PairHeader.flags & (PxContactPairHeaderFlag::eREMOVED_ACTOR_0 | PxContactPairHeaderFlag::eREMOVED_ACTOR_1)) return;
+		const int ObjA = static_cast<int>(reinterpret_cast<intptr_t>(PairHeader.actors[0]->userData)) - 1;
+		const int ObjB = static_cast<int>(reinterpret_cast<intptr_t>(PairHeader.actors[1]->userData)) - 1;
+
+		if (bTrackTouches && ObjA >= 0 && ObjB >= 0)
+		{
+			const uint64_t Key = static_cast<uint64_t>(std::min(ObjA, ObjB)) << 32 | std::max(ObjA, ObjB);
+			for (PxU32 i = 0; i < NbPairs; i++)
+			{
+				// A pair can both start and stop touching within one simulate call
+				if (Pairs[i].events & PxPairFlag::eNOTIFY_TOUCH_FOUND)
+				{
+					TouchCounts[Key]++;
+				}
+				if (Pairs[i].events & PxPairFlag::eNOTIFY_TOUCH_LOST)
+				{
+					const auto Found = TouchCounts.find(Key);
+					if (Found != TouchCounts.end() && --Found->second <= 0) TouchCounts.erase(Found);
+				}
+			}
+		}
+		if (!bRecordImpacts) return;
+
+		PxContactPairPoint Points[16];
+		for (PxU32 i = 0; i < NbPairs; i++)
+		{
+			const auto& Pair = Pairs[i];
+			if (!(Pair.events & PxPairFlag::eNOTIFY_TOUCH_FOUND)) continue;
+
+			const PxU32 NbPoints = Pair.extractContacts(Points, sizeof(Points) / sizeof(Points[0]));
+			if (NbPoints == 0) continue;
+			PxVec3 Impulse(0.0f);
+			PxVec3 Position(0.0f);
+			for (PxU32 j = 0; j < NbPoints; j++)
+			{
+				Impulse += Points[j].impulse;
+				Position += Points[j].position;
+			}
+			const float Magnitude = Impulse.magnitude();
+			if (Magnitude < ImpulseThreshold) continue;
+			Pending.push_back({ Frame, ObjA, ObjB, Position / static_cast<float>(NbPoints), Magnitude });
+		}
+	}
+	virtual void onConstraintBreak(physx::PxConstraintInfo* Constraints, physx::PxU32 Count) override {}
+	virtual void onWake(physx::PxActor** Actors, physx::PxU32 Count) override {}
+	virtual void onSleep(physx::PxActor** Actors, physx::PxU32 Count) override {}
+	virtual void onTrigger(physx::PxTriggerPair* Pairs, physx::PxU32 Count) override {}
+	virtual void onAdvance(const physx::PxRigidBody* const* BodyBuffer, const physx::PxTransform* PoseBuffer, const physx::PxU32 Count) override {}
+
+	bool bRecordImpacts = false;
+	float ImpulseThreshold = 0.0f;
+	int Frame = 0;
+	std::vector<PhysImpact> Pending;
+
+	// Shape pairs in touch per pair of observed bodies, keyed by both indices
+	bool bTrackTouches = false;
+	std::unordered_map<uint64_t, int> TouchCounts;
+};
+
+inline int PhysFindIsland(std::vector<int>& Parents, int Index)
+{
+	while (Parents[Index] != Index)
+	{
+		Parents[Index] = Parents[Parents[Index]];
+		Index = Parents[Index];
+	}
+	return Index;
+}
+
+// Writes the lowest object index of the contact island of every observed body
+inline void PhysFindIslands(const PhysContactCallback& Contacts, int NumOfBodies, std::vector<int>& Parents, int* OutIslands)
+{
+	Parents.resize(NumOfBodies);
+	for (int i = 0; i < NumOfBodies; i++)
+	{
+		Parents[i] = i;
+	}
+
+	// Union by lower index keeps the lowest object of every island as its root
+	for (const auto& Touch : Contacts.TouchCounts)
+	{
+		const int RootA = PhysFindIsland(Parents, static_cast<int>(Touch.first >> 32));
+		const int RootB = PhysFindIsland(Parents, static_cast<int>(Touch.first & 0xFFFFFFFF));
+		if (RootA == RootB) continue;
+		Parents[std::max(RootA, RootB)] = std::min(RootA, RootB);
+	}
+
+	for (int i = 0; i < NumOfBodies; i++)
+	{
+		OutIslands[i] = PhysFindIsland(Parents, i);
+	}
+}
+
+// Activity of the scene after the last substep of a frame
+struct PhysFrameActivity
+{
+	int AwakeBodies = 0;
+	// Shape pairs touching, and shape pairs the narrowphase processed
+	int ContactPairs = 0;
+	int NarrowphasePairs = 0;
+	// Shape pairs with overlapping bounds, from PhysBroadphasePairCounter
+	int BroadphasePairs = 0;
+};
+
+// Running count of broadphase pairs since the bake started.
+// PhysX only reports the pairs found and lost by the last simulate call, so update after every substep.
+struct PhysBroadphasePairCounter
+{
+	int Pairs = 0;
+
+	void Update(physx::PxScene* Scene)
+	{
+		physx::PxSimulationStatistics Stats;
+		Scene->getSimulationStatistics(Stats);
+		Pairs += static_cast<int>(Stats.nbNewPairs) - static_cast<int>(Stats.nbLostPairs);
+	}
+};
+
+inline PhysFrameActivity PhysGetFrameActivity(physx::PxScene* Scene, const std::vector<physx::PxRigidDynamic*>& Bodies,
+	const PhysBroadphasePairCounter& Broadphase)
+{
+	PhysFrameActivity Activity;
+	Activity.AwakeBodies = static_cast<int>(std::count_if(Bodies.begin(), Bodies.end(),
+		[](const physx::PxRigidDynamic* Body) { return !Body->isSleeping(); }));
+	physx::PxSimulationStatistics Stats;
+	Scene->getSimulationStatistics(Stats);
+	Activity.ContactPairs = Stats.nbDiscreteContactPairsWithContacts;
+	Activity.NarrowphasePairs = Stats.nbDiscreteContactPairsTotal;
+	Activity.BroadphasePairs = Broadphase.Pairs;
+	return Activity;
+}
+
+// Impulse of an explosion on a body at Position, linear fall-off between the two distances. False beyond the outer one.
+inline bool PhysGetExplosionImpulse(const physx::PxVec3& Center, const physx::PxVec3& Position,
+	float Impulse, float FallOffMinDistance, float FallOffMaxDistance, physx::PxVec3& OutImpulse)
+{
+	physx::PxVec3 Dir = Position - Center;
+	const float SqrDist = Dir.magnitudeSquared();
+	if (SqrDist > FallOffMaxDistance * FallOffMaxDistance) return false;
+	Dir.normalize();
+
+	float Multiplier = Impulse;
+	if (SqrDist > FallOffMinDistance * FallOffMinDistance)
+		Multiplier *= 1.0f - (std::sqrt(SqrDist) - FallOffMinDistance) / (FallOffMaxDistance - FallOffMinDistance);
+	OutImpulse = Dir * Multiplier;
+	return true;
+}
+
+// In the order of EForceFieldType
+enum class PhysFieldType
+{
+	Wind,
+	Vortex,
+	RadialPull,
+	DirectionalGust
+};
+
+constexpr float PhysFieldEpsilon = 1.e-4f;
+
+// Strength of a force field at its center, FieldTime seconds into the field
+inline float PhysGetFieldScale(PhysFieldType Type, float Strength, float GustFrequency, float FieldTime)
+{
+	if (Type != PhysFieldType::DirectionalGust) return Strength;
+	return Strength * std::max(0.0f, std::sin(2.0f * physx::PxPi * GustFrequency * FieldTime));
+}
+
+// Force on a body R away from the field center. Dir is normalized, InvRadius is 0 for scene-wide fields.
+inline physx::PxVec3 PhysGetFieldForce(PhysFieldType Type, float Scale, float InvRadius, const physx::PxVec3& Dir, const physx::PxVec3& R)
+{
+	// Linear fall-off towards the radius
+	const float SqrDist = R.magnitudeSquared();
+	const float Dist = SqrDist / std::sqrt(SqrDist + PhysFieldEpsilon);
+	const float Magnitude = Scale * std::max(0.0f, 1.0f - Dist * InvRadius);
+
+	switch (Type)
+	{
+	case PhysFieldType::RadialPull:
+		return -R * (Magnitude / std::sqrt(SqrDist + PhysFieldEpsilon));
+	case PhysFieldType::Vortex:
+		{
+			// Tangent around the axis, normalized so the same strength applies at any distance from the axis
+			const physx::PxVec3 Tangent = Dir.cross(R);
+			return Tangent * (Magnitude / std::sqrt(Tangent.magnitudeSquared() + PhysFieldEpsilon));
+		}
+	default:
+		return Dir * Magnitude;
+	}
+}
@@ -2,12 +2,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <string>
 #include <thread>
 #include "AdvPhysDataTypes.h"
+#include "AdvPhysEventTimeline.h"
 #include "AdvPhysSceneController.h"
+#include "AdvPhysSceneDesc.h"
 
 #include "ThirdParty/PhysX3/PhysX_3.4/Include/PxPhysics.h"
 #include "ThirdParty/PhysX3/PhysX_3.4/Include/PxPhysicsAPI.h"
+#include "PhysRecordCore.h"
 
 using namespace physx; 
 
@@ -16,6 +21,18 @@ struct PhysCompoundShape
 	std::vector<PxShape*> Shapes;
 };
 
+// Seconds spent in each phase of the last record. Cooking adds up from the last ClearScene.
+struct PhysRecordTimings
+{
+	double Cooking = 0.0;
+	double Events = 0.0;
+	double Simulate = 0.0;
+	double FetchResults = 0.0;
+	double Contacts = 0.0;
+	double Readback = 0.0;
+	double Hashing = 0.0;
+};
+
 class RUNTIMEBAKEDPHYSICS_API PhysSimulator
 {
 public:
@@ -26,18 +43,42 @@ public:
 	void Cleanup();
 
 	// Events
-	void ReserveEvents(int FrameCount);
-	void AddEvent(float Time, AAdvPhysEventBase* Event, float Interval, int FrameCount);
+	void SetEventTimeline(FPhysEventTimelinePtr Timeline);
+	void AddForceField(AAdvPhysEvent_ForceField* Field, float Interval, int FrameCount);
 	void FreeEvents();
 
+	// Impacts with a total impulse below the threshold are not recorded
+	void SetImpactRecording(bool bEnabled, float ImpulseThreshold);
+	// Records which observed bodies rest on each other every frame
+	void SetIslandRecording(bool bEnabled);
+	// Simulation steps per recorded frame, force fields apply on each
+	void SetSubsteps(int Count);
+	// Records the cost and activity of every frame into the bake's telemetry
+	void SetTelemetryRecording(bool bEnabled);
+	// Hashes the recorded poses of every frame into the bake's FrameHashes
+	void SetStateHashRecording(bool bEnabled);
+	// Pins the PhysX settings that affect reproducibility of scenes created from now on
+	void SetDeterministic(bool bEnabled);
+	// Settings of scenes created and bodies added from now on
+	void SetProfile(const FPhysBakeProfile& InProfile);
+
 	// Scene-Related
 	void ClearScene();
+	// Removes every body but keeps the scene and the cooked meshes, for scenes filled again and again
+	void ClearBodies();
 	
 	void AddStaticBody(UStaticMeshComponent* Comp, EShapeType Type);
 	void AddDynamicBody(UStaticMeshComponent* Comp, bool bUseSimpleGeometry = false);
 
+	// Bodies of the scene with their cooked shapes, dynamic ones in bake order
+	void ExportScene(FPhysSceneDesc& OutDesc) const;
+	// Adds the bodies of a description, usually exported by another process
+	void ImportScene(const FPhysSceneDesc& Desc);
+
 	void StartRecord(FPhysRecordData* Destination, float RecordInterval, int FrameCount, float GravityZ);
 	void StopRecord();
+	// Stops a running record and blocks until its thread has exited, after which the destination is no longer written
+	void StopRecordAndWait();
 	// Others
 	bool IsInitialized() const;
 	bool IsRecording() const;
@@ -50,33 +91,65 @@ public:
 	inline static PxFoundation*				Foundation;
 	inline static PxPhysics*				Physics;
 
+	// Shared by the scenes of every simulator, created along with Physics
 	inline static PxDefaultCpuDispatcher*	Dispatcher;
 	inline static PxPvd*						Pvd;
+	// PVD transports keep a pointer to the host name
+	inline static std::string				PvdHost;
 	inline static PxCooking*				Cooking;
+	// Worker threads of the shared CPU dispatcher, read when the first simulator initializes
+	inline static int						DispatcherThreads = 2;
 
 	PxScene* Scene;
 
 	std::unordered_map<uint64, PxConvexMesh*> ConvexMeshes;
 	std::vector<PxRigidDynamic*> ObservedBodies;
 
-	std::vector<std::shared_ptr<FPhysEventNode>> Events;
+	FPhysEventTimelinePtr EventTimeline;
+	std::vector<PxRigidDynamic*> EventBodies;
+	std::vector<FPhysForceFieldEntry> ForceFields;
 
 	FPhysRecordData* RecordData;
+	PhysRecordTimings Timings;
 	
 protected:
 	void RecordInternal();
-	void HandleEventsInternal(int Frame);
+	// Returns the number of events fired
+	int HandleEventsInternal(int Frame);
+	void ApplyForceFieldsInternal(int Frame);
+	void QueryEventBodiesInternal(const AAdvPhysEventBase* Event, std::vector<PxRigidDynamic*>& OutBodies);
+	void RecordImpactsInternal(int Frame);
+	void RecordIslandsInternal(int Frame);
 	
 	void CreateSceneInternal();
+	void ApplyProfileInternal(PxRigidDynamic* Body) const;
+	PhysSceneSettings GetSceneSettingsInternal() const;
+	PxU32 GetFilterReportInternal() const;
+	void ConnectPvdInternal() const;
 
 	void GetShapeInternal(const UStaticMeshComponent* Comp, EShapeType Type, PhysCompoundShape& OutShape);
 	std::shared_ptr<PxGeometry> GetSimpleGeometry(const UStaticMeshComponent* Comp) const;
 	PxConvexMesh* GetConvexMeshInternal(UStaticMesh* Mesh, int ConvexElemIndex);
+	PxShape* CreateShapeInternal(const FPhysShapeDesc& Desc);
 	
 	inline static int StaticRefCount = 0;
 	
 	bool bIsInitialized;
-	bool bIsRecording;
-	bool bWantsToStop;
+	// Shared with the record thread
+	std::atomic<bool> bIsRecording;
+	std::atomic<bool> bWantsToStop;
 	std::thread RecordThread;
+	int EventCursor;
+	int Substeps = 1;
+	bool bRecordTelemetry = false;
+	bool bRecordStateHashes = false;
+	bool bDeterministic = false;
+	FPhysBakeProfile Profile;
+
+	// SoA scratch for force field evaluation, positions then forces
+	std::vector<float> FieldScratch;
+
+	PhysContactCallback ContactCallback;
+	std::vector<std::pair<uint64, int>> ImpactOrder;
+	std::vector<int> IslandParents;
 };
\ No newline at end of file
@@ -2,5 +2,25 @@
 
 #include "RuntimeBakedPhysics.h"
 #include "Modules/ModuleManager.h"
+#include "Misc/CoreDelegates.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, RuntimeBakedPhysics, "RuntimeBakedPhysics" );
+#include "AdvPhysStats.h"
+
+class FRuntimeBakedPhysicsModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddStatic(&ResetAdvPhysFrameCounters);
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	}
+
+private:
+	FDelegateHandle BeginFrameHandle;
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FRuntimeBakedPhysicsModule, RuntimeBakedPhysics, "RuntimeBakedPhysics" );
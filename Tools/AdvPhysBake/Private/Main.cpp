@@ -0,0 +1,119 @@
+#include "PhysBaker.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+// Poses written by --out, little-endian: "APBK" uint32 Version, int32 FrameCount, int32 ObjectCount, float FrameInterval,
+// then per frame and object a float3 position and float4 quaternion
+static bool WritePoses(const char* Path, const PhysBakeResult& Result)
+{
+	std::ofstream File(Path, std::ios::binary);
+	const uint32_t Version = 1;
+	File.write("APBK", 4);
+	File.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+	File.write(reinterpret_cast<const char*>(&Result.FrameCount), sizeof(Result.FrameCount));
+	File.write(reinterpret_cast<const char*>(&Result.ObjectCount), sizeof(Result.ObjectCount));
+	File.write(reinterpret_cast<const char*>(&Result.FrameInterval), sizeof(Result.FrameInterval));
+	File.write(reinterpret_cast<const char*>(Result.Poses.data()), Result.Poses.size() * sizeof(PhysPose));
+	return static_cast<bool>(File);
+}
+
+// Same columns as AAdvPhysScene::ExportTelemetry
+static bool WriteTelemetry(const char* Path, const PhysBakeResult& Result)
+{
+	FILE* File = std::fopen(Path, "w");
+	if (!File) return false;
+	std::fprintf(File, "frame,simulate_ms,awake_bodies,contact_pairs,narrowphase_pairs,broadphase_pairs,events\n");
+	for (size_t i = 0; i < Result.Telemetry.size(); i++)
+	{
+		const auto& Frame = Result.Telemetry[i];
+		std::fprintf(File, "%zu,%f,%d,%d,%d,%d,%d\n",
+			i, Frame.SimulateTime * 1000.0f, Frame.AwakeBodies, Frame.ContactPairs, Frame.NarrowphasePairs, Frame.BroadphasePairs, Frame.Events);
+	}
+	return std::fclose(File) == 0;
+}
+
+static int PrintUsage()
+{
+	std::fprintf(stderr,
+		"Usage: advphys-bake <scene.apsf> [--threads N] [--repeat N] [--substeps N] [--out poses.bin] [--telemetry frames.csv]\n"
+		"Bakes a scene exported by AAdvPhysScene::ExportSceneFile and prints the time spent in each phase.\n"
+		"--telemetry needs a scene exported with bRecordTelemetry; with bRecordStateHashes, --repeat reports whether runs match.\n");
+	return 2;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) return PrintUsage();
+
+	const char* ScenePath = argv[1];
+	const char* OutPath = nullptr;
+	const char* TelemetryPath = nullptr;
+	int Threads = static_cast<int>(std::thread::hardware_concurrency());
+	int Repeat = 1;
+	int Substeps = 1;
+	for (int i = 2; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) Threads = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) Repeat = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--substeps") == 0 && i + 1 < argc) Substeps = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) OutPath = argv[++i];
+		else if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) TelemetryPath = argv[++i];
+		else return PrintUsage();
+	}
+
+	PhysSceneData Scene;
+	std::string Error;
+	if (!LoadPhysSceneFile(ScenePath, Scene, Error))
+	{
+		std::fprintf(stderr, "%s\n", Error.c_str());
+		return 1;
+	}
+
+	PhysBaker Baker(Threads);
+	PhysBakeResult Result;
+	// Repeated runs of scenes exported with bRecordStateHashes are checked against the first, to see whether bakes reproduce
+	std::vector<uint64_t> FirstHashes;
+	for (int Run = 0; Run < Repeat; Run++)
+	{
+		if (!Baker.Bake(Scene, Substeps, Result, Error))
+		{
+			std::fprintf(stderr, "%s\n", Error.c_str());
+			return 1;
+		}
+
+		const auto& T = Result.Timings;
+		const double Total = T.Build + T.Events + T.Simulate + T.FetchResults + T.Contacts + T.Readback + T.Hashing;
+		std::printf("run %d: %d objects, %d frames, %zu impacts, %.3fs total\n", Run, Result.ObjectCount, Result.FrameCount, Result.Impacts.size(), Total);
+		std::printf("  build %.3fs  events %.3fs  simulate %.3fs  fetchResults %.3fs  contacts %.3fs  readback %.3fs  hashing %.3fs\n",
+			T.Build, T.Events, T.Simulate, T.FetchResults, T.Contacts, T.Readback, T.Hashing);
+
+		if (Result.FrameHashes.empty()) continue;
+		if (Run == 0)
+		{
+			FirstHashes = Result.FrameHashes;
+			continue;
+		}
+		const auto Diverged = std::mismatch(FirstHashes.begin(), FirstHashes.end(), Result.FrameHashes.begin());
+		if (Diverged.first == FirstHashes.end())
+			std::printf("  identical to run 0\n");
+		else
+			std::printf("  diverges from run 0 at frame %d\n", static_cast<int>(Diverged.first - FirstHashes.begin()));
+	}
+
+	if (OutPath && !WritePoses(OutPath, Result))
+	{
+		std::fprintf(stderr, "Could not write %s\n", OutPath);
+		return 1;
+	}
+	if (TelemetryPath && !WriteTelemetry(TelemetryPath, Result))
+	{
+		std::fprintf(stderr, "Could not write %s\n", TelemetryPath);
+		return 1;
+	}
+	return 0;
+}
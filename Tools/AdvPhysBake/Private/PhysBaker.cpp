@@ -0,0 +1,482 @@
+#include "PhysBaker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "PhysHashCore.h"
+
+using namespace physx;
+
+static double Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static PxVec3 ToPx(const PhysVec3& Value)
+{
+	return PxVec3(Value.X, Value.Y, Value.Z);
+}
+
+static PxTransform ToPx(const PhysPose& Pose)
+{
+	return PxTransform(ToPx(Pose.Position), PxQuat(Pose.Rotation.X, Pose.Rotation.Y, Pose.Rotation.Z, Pose.Rotation.W));
+}
+
+// FNV-1a over the poses of a frame. Float poses hash differently from the bakes of the game module, so these only compare tool runs.
+static uint64_t HashPoses(const PhysPose* Poses, int Count)
+{
+	const auto Bytes = reinterpret_cast<const unsigned char*>(Poses);
+	uint64_t Hash = 14695981039346656037ull;
+	for (size_t i = 0; i < Count * sizeof(PhysPose); i++)
+	{
+		Hash = (Hash ^ Bytes[i]) * 1099511628211ull;
+	}
+	return Hash;
+}
+
+static PhysSceneSettings GetSceneSettings(const PhysSceneData& Scene)
+{
+	const auto& Profile = Scene.Profile;
+	PhysSceneSettings Settings;
+	Settings.bMultiBoxPruning = Profile.bMultiBoxPruning;
+	Settings.WorldBounds = PxBounds3(
+		PxVec3(static_cast<float>(Profile.WorldBoundsMin[0]), static_cast<float>(Profile.WorldBoundsMin[1]), static_cast<float>(Profile.WorldBoundsMin[2])),
+		PxVec3(static_cast<float>(Profile.WorldBoundsMax[0]), static_cast<float>(Profile.WorldBoundsMax[1]), static_cast<float>(Profile.WorldBoundsMax[2])));
+	Settings.MBPSubdivisions = Profile.MBPSubdivisions;
+	Settings.bEnablePCM = Profile.bEnablePCM;
+	Settings.bEnableStabilization = Profile.bEnableStabilization;
+	Settings.bEnableCCD = Profile.bEnableCCD;
+	Settings.PositionIterations = Profile.PositionIterations;
+	Settings.VelocityIterations = Profile.VelocityIterations;
+	Settings.SleepThreshold = Profile.SleepThreshold;
+	Settings.bDeterministic = Scene.bDeterministic;
+	return Settings;
+}
+
+static PhysPose FromPx(const PxTransform& Pose)
+{
+	PhysPose Result;
+	Result.Position = { Pose.p.x, Pose.p.y, Pose.p.z };
+	Result.Rotation = { Pose.q.x, Pose.q.y, Pose.q.z, Pose.q.w };
+	return Result;
+}
+
+static uint64_t GetHash(const PxVec3& Point, const double* WorldCenter, float CellSize)
+{
+	return PhysGetHash(Point.x, Point.y, Point.z, WorldCenter, CellSize);
+}
+
+struct BakeOverlapCallback : PxOverlapCallback
+{
+	explicit BakeOverlapCallback(std::vector<PxRigidDynamic*>& Out) :
+		PxOverlapCallback(Hits, 256),
+		Out(Out)
+	{ }
+
+	virtual PxAgain processTouches(const PxOverlapHit* Buffer, PxU32 NbHits) override
+	{
+		for (PxU32 i = 0; i < NbHits; i++)
+		{
+			if (const auto Body = Buffer[i].actor->is<PxRigidDynamic>())
+				Out.push_back(Body);
+		}
+		return true;
+	}
+
+	PxOverlapHit Hits[256];
+	std::vector<PxRigidDynamic*>& Out;
+};
+
+enum class BakeEventKind
+{
+	Explosion,
+	ForceField
+};
+
+// Event of the scene file with its properties parsed, mirroring AAdvPhysEvent_Explosion and AAdvPhysEvent_ForceField
+struct BakeEvent
+{
+	BakeEventKind Kind;
+	float Time;
+	int StartFrame;
+	int EndFrame;
+	PxTransform Pose;
+	// Explosion
+	float Impulse;
+	float FallOffMinDistance;
+	float FallOffMaxDistance;
+	// Force field
+	PhysFieldType FieldType;
+	float Strength;
+	float Radius;
+	PxVec3 Direction;
+	float GustFrequency;
+	bool bIgnoreMass;
+
+	float GetInfluenceRadius() const
+	{
+		return Kind == BakeEventKind::Explosion ? FallOffMaxDistance : Radius;
+	}
+};
+
+static bool ParseEvent(const PhysEventData& Data, float Interval, int FrameCount, BakeEvent& Out)
+{
+	Out.Time = Data.GetFloat("Time", 0.0f);
+	Out.Pose = ToPx(Data.Pose);
+	Out.StartFrame = static_cast<int>(std::min(Out.Time / Interval, static_cast<float>(FrameCount - 1)));
+	Out.EndFrame = Out.StartFrame;
+
+	if (Data.FindProperty("FallOffMaxDistance"))
+	{
+		Out.Kind = BakeEventKind::Explosion;
+		Out.Impulse = Data.GetFloat("Impulse", 5000.0f);
+		Out.FallOffMinDistance = Data.GetFloat("FallOffMinDistance", 10.0f);
+		Out.FallOffMaxDistance = Data.GetFloat("FallOffMaxDistance", 100.0f);
+		return true;
+	}
+	if (const auto FieldType = Data.FindProperty("FieldType"))
+	{
+		Out.Kind = BakeEventKind::ForceField;
+		Out.FieldType = *FieldType == "Vortex" ? PhysFieldType::Vortex
+			: *FieldType == "RadialPull" ? PhysFieldType::RadialPull
+			: *FieldType == "DirectionalGust" ? PhysFieldType::DirectionalGust
+			: PhysFieldType::Wind;
+		const float Duration = Data.GetFloat("Duration", 1.0f);
+		Out.EndFrame = static_cast<int>(std::min((Out.Time + Duration) / Interval, static_cast<float>(FrameCount - 1)));
+		Out.Strength = Data.GetFloat("Strength", 1000.0f);
+		Out.Radius = Data.GetFloat("Radius", 0.0f);
+		Out.GustFrequency = Data.GetFloat("GustFrequency", 1.0f);
+		const auto IgnoreMass = Data.FindProperty("bIgnoreMass");
+		Out.bIgnoreMass = !IgnoreMass || *IgnoreMass == "True";
+
+		Out.Direction = PxVec3(1.0f, 0.0f, 0.0f);
+		if (const auto Direction = Data.FindProperty("Direction"))
+		{
+			std::sscanf(Direction->c_str(), "(X=%f,Y=%f,Z=%f)", &Out.Direction.x, &Out.Direction.y, &Out.Direction.z);
+		}
+		Out.Direction = Out.Pose.q.rotate(Out.Direction);
+		Out.Direction.normalizeSafe();
+		return true;
+	}
+	return false;
+}
+
+static void QueryEventBodies(PxScene* Scene, const BakeEvent& Event, const std::vector<PxRigidDynamic*>& All, std::vector<PxRigidDynamic*>& Out)
+{
+	const float Radius = Event.GetInfluenceRadius();
+	if (Radius <= 0.0f)
+	{
+		Out = All;
+		return;
+	}
+
+	Out.clear();
+	BakeOverlapCallback Callback(Out);
+	const PxQueryFilterData FilterData(PxQueryFlag::eDYNAMIC | PxQueryFlag::eNO_BLOCK);
+	Scene->overlap(PxSphereGeometry(Radius), PxTransform(Event.Pose.p), Callback, FilterData);
+	std::sort(Out.begin(), Out.end());
+	Out.erase(std::unique(Out.begin(), Out.end()), Out.end());
+}
+
+static void ApplyExplosion(const BakeEvent& Event, const std::vector<PxRigidDynamic*>& Bodies)
+{
+	const PxVec3 ExplosionPos = Event.Pose.p;
+	for (const auto Body : Bodies)
+	{
+		PxVec3 Impulse;
+		if (!PhysGetExplosionImpulse(ExplosionPos, Body->getGlobalPose().p, Event.Impulse, Event.FallOffMinDistance, Event.FallOffMaxDistance, Impulse))
+			continue;
+		Body->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, false);
+		PxRigidBodyExt::addForceAtPos(*Body, Impulse, ExplosionPos, PxForceMode::eIMPULSE);
+	}
+}
+
+static void ApplyForceField(const BakeEvent& Event, float FieldTime, const std::vector<PxRigidDynamic*>& Bodies)
+{
+	const float Scale = PhysGetFieldScale(Event.FieldType, Event.Strength, Event.GustFrequency, FieldTime);
+	const float InvRadius = Event.Radius > 0 ? 1.0f / Event.Radius : 0.0f;
+
+	for (const auto Body : Bodies)
+	{
+		if (Body->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC) continue;
+		const PxVec3 Force = PhysGetFieldForce(Event.FieldType, Scale, InvRadius, Event.Direction, Body->getGlobalPose().p - Event.Pose.p);
+		Body->addForce(Force, Event.bIgnoreMass ? PxForceMode::eACCELERATION : PxForceMode::eFORCE);
+	}
+}
+
+PhysBaker::PhysBaker(int DispatcherThreads)
+{
+	Foundation = PxCreateFoundation(PX_FOUNDATION_VERSION, Allocator, ErrorCallback);
+	if (!Foundation) return;
+	Physics = PxCreatePhysics(PX_PHYSICS_VERSION, *Foundation, PxTolerancesScale(), true, nullptr);
+	if (!Physics) return;
+	Cooking = PxCreateCooking(PX_PHYSICS_VERSION, *Foundation, PxCookingParams(Physics->getTolerancesScale()));
+	Dispatcher = PxDefaultCpuDispatcherCreate(std::max(1, DispatcherThreads));
+}
+
+PhysBaker::~PhysBaker()
+{
+	if (Dispatcher) Dispatcher->release();
+	if (Cooking) Cooking->release();
+	if (Physics) Physics->release();
+	if (Foundation) Foundation->release();
+}
+
+PxShape* PhysBaker::CreateShape(const PhysShapeData& Data)
+{
+	PxMaterial* Material = Physics->createMaterial(Data.StaticFriction, Data.DynamicFriction, Data.Restitution);
+	const PxMeshScale Scale(ToPx(Data.Scale));
+	PxShape* Shape = nullptr;
+
+	switch (Data.Type)
+	{
+	case PhysShapeType::Sphere:
+		Shape = Physics->createShape(PxSphereGeometry(Data.Params.X), *Material);
+		break;
+	case PhysShapeType::Capsule:
+		Shape = Physics->createShape(PxCapsuleGeometry(Data.Params.X, Data.Params.Y), *Material);
+		break;
+	case PhysShapeType::Box:
+		Shape = Physics->createShape(PxBoxGeometry(ToPx(Data.Params)), *Material);
+		break;
+	case PhysShapeType::Convex:
+		{
+			PxConvexMeshDesc Desc;
+			Desc.points.count = static_cast<PxU32>(Data.Vertices.size());
+			Desc.points.stride = sizeof(PhysVec3);
+			Desc.points.data = Data.Vertices.data();
+			Desc.flags = PxConvexFlag::eCOMPUTE_CONVEX | PxConvexFlag::eDISABLE_MESH_VALIDATION | PxConvexFlag::eFAST_INERTIA_COMPUTATION;
+
+			PxDefaultMemoryOutputStream Buf;
+			if (!Cooking->cookConvexMesh(Desc, Buf)) break;
+			PxDefaultMemoryInputData Input(Buf.getData(), Buf.getSize());
+			const auto Mesh = Physics->createConvexMesh(Input);
+			if (!Mesh) break;
+			Shape = Physics->createShape(PxConvexMeshGeometry(Mesh, Scale), *Material);
+			Mesh->release();
+			break;
+		}
+	case PhysShapeType::TriMesh:
+		{
+			PxTriangleMeshDesc Desc;
+			Desc.points.count = static_cast<PxU32>(Data.Vertices.size());
+			Desc.points.stride = sizeof(PhysVec3);
+			Desc.points.data = Data.Vertices.data();
+			Desc.triangles.count = static_cast<PxU32>(Data.Indices.size() / 3);
+			Desc.triangles.stride = 3 * sizeof(uint32_t);
+			Desc.triangles.data = Data.Indices.data();
+
+			const auto Mesh = Cooking->createTriangleMesh(Desc, Physics->getPhysicsInsertionCallback());
+			if (!Mesh) break;
+			Shape = Physics->createShape(PxTriangleMeshGeometry(Mesh, Scale), *Material);
+			Mesh->release();
+			break;
+		}
+	}
+	Material->release();
+
+	if (Shape) Shape->setLocalPose(ToPx(Data.LocalPose));
+	return Shape;
+}
+
+bool PhysBaker::Bake(const PhysSceneData& Scene, int Substeps, PhysBakeResult& OutResult, std::string& OutError)
+{
+	if (!IsValid())
+	{
+		OutError = "PhysX failed to initialize";
+		return false;
+	}
+	if (Scene.FrameCount <= 0 || Scene.FrameInterval <= 0.0f)
+	{
+		OutError = "Scene has no frames to bake";
+		return false;
+	}
+
+	OutResult = PhysBakeResult();
+	auto& Timings = OutResult.Timings;
+	double Start = Now();
+
+	PhysContactCallback Contacts;
+	Contacts.bRecordImpacts = Scene.bRecordImpacts;
+	Contacts.ImpulseThreshold = Scene.ImpactImpulseThreshold;
+	Contacts.bTrackTouches = Scene.bRecordIslands;
+	const PhysSceneSettings Settings = GetSceneSettings(Scene);
+	const PxU32 Report = PhysGetContactReport(Scene.bRecordImpacts, Scene.bRecordIslands, Settings);
+
+	PxSceneDesc SceneDesc(Physics->getTolerancesScale());
+	SceneDesc.cpuDispatcher = Dispatcher;
+	PhysApplySceneSettings(SceneDesc, Settings);
+	SceneDesc.filterShaderData = &Report;
+	SceneDesc.filterShaderDataSize = sizeof(Report);
+	SceneDesc.gravity = PxVec3(0.0f, 0.0f, Scene.GravityZ);
+	SceneDesc.simulationEventCallback = Report & (ReportImpacts | ReportTouches) ? &Contacts : nullptr;
+	PxScene* PScene = Physics->createScene(SceneDesc);
+	PhysAddBroadPhaseRegions(PScene, Settings);
+
+	std::vector<PxRigidActor*> Actors;
+	std::vector<PxRigidDynamic*> Bodies;
+	for (const auto& BodyData : Scene.Bodies)
+	{
+		const PxTransform Pose = ToPx(BodyData.Pose);
+		PxRigidActor* Body = BodyData.bDynamic
+			? static_cast<PxRigidActor*>(Physics->createRigidDynamic(Pose))
+			: static_cast<PxRigidActor*>(Physics->createRigidStatic(Pose));
+		for (const auto& ShapeData : BodyData.Shapes)
+		{
+			const auto Shape = CreateShape(ShapeData);
+			if (!Shape) continue;
+			Body->attachShape(*Shape);
+			Shape->release();
+		}
+		if (const auto Dynamic = Body->is<PxRigidDynamic>())
+		{
+			PxRigidBodyExt::setMassAndUpdateInertia(*Dynamic, BodyData.Mass);
+			Dynamic->setLinearVelocity(ToPx(BodyData.LinearVelocity));
+			Dynamic->setAngularVelocity(ToPx(BodyData.AngularVelocity));
+			PhysApplyBodySettings(Dynamic, Settings);
+			Dynamic->userData = reinterpret_cast<void*>(static_cast<intptr_t>(Bodies.size() + 1));
+			Bodies.push_back(Dynamic);
+		}
+		PScene->addActor(*Body);
+		Actors.push_back(Body);
+	}
+
+	std::vector<BakeEvent> Events;
+	for (const auto& EventData : Scene.Events)
+	{
+		BakeEvent Event;
+		if (ParseEvent(EventData, Scene.FrameInterval, Scene.FrameCount, Event))
+			Events.push_back(Event);
+		else
+			std::fprintf(stderr, "Skipping event of unsupported class %s\n", EventData.Class.c_str());
+	}
+	std::stable_sort(Events.begin(), Events.end(), [](const BakeEvent& A, const BakeEvent& B) { return A.Time < B.Time; });
+
+	const int NumOfBodies = static_cast<int>(Bodies.size());
+	OutResult.FrameCount = Scene.FrameCount;
+	OutResult.ObjectCount = NumOfBodies;
+	OutResult.FrameInterval = Scene.FrameInterval;
+	OutResult.Poses.resize(static_cast<size_t>(Scene.FrameCount) * NumOfBodies);
+	if (Scene.bEnableSOD) OutResult.Hashes.resize(static_cast<size_t>(Scene.FrameCount) * NumOfBodies * 2);
+	if (Scene.bRecordIslands) OutResult.Islands.resize(static_cast<size_t>(Scene.FrameCount) * NumOfBodies);
+	if (Scene.bRecordTelemetry) OutResult.Telemetry.resize(Scene.FrameCount);
+	if (Scene.bRecordStateHashes) OutResult.FrameHashes.resize(Scene.FrameCount);
+	if (Scene.bRecordImpacts)
+	{
+		OutResult.ImpactFrameStarts.reserve(Scene.FrameCount + 1);
+		OutResult.ImpactFrameStarts.push_back(0);
+	}
+	Timings.Build = Now() - Start;
+
+	std::vector<PxRigidDynamic*> EventBodies;
+	std::vector<std::pair<uint64_t, int>> ImpactOrder;
+	std::vector<int> IslandParents;
+	size_t EventCursor = 0;
+	PhysBroadphasePairCounter Broadphase;
+	Substeps = std::max(1, Substeps);
+	const float StepInterval = Scene.FrameInterval / Substeps;
+	for (int i = 0; i < Scene.FrameCount; i++)
+	{
+		Start = Now();
+		int NumOfEvents = 0;
+		for (; EventCursor < Events.size() && Events[EventCursor].StartFrame <= i; EventCursor++)
+		{
+			const auto& Event = Events[EventCursor];
+			if (Event.Kind != BakeEventKind::Explosion) continue;
+			QueryEventBodies(PScene, Event, Bodies, EventBodies);
+			ApplyExplosion(Event, EventBodies);
+			NumOfEvents++;
+		}
+		double Next = Now();
+		Timings.Events += Next - Start;
+
+		Contacts.Frame = i;
+		const double FrameSimulateStart = Timings.Simulate + Timings.FetchResults;
+		for (int Step = 0; Step < Substeps; Step++)
+		{
+			// Forces only last for one step
+			Start = Next;
+			for (const auto& Event : Events)
+			{
+				if (Event.Kind != BakeEventKind::ForceField || i < Event.StartFrame || i > Event.EndFrame) continue;
+				QueryEventBodies(PScene, Event, Bodies, EventBodies);
+				ApplyForceField(Event, (i - Event.StartFrame) * Scene.FrameInterval, EventBodies);
+			}
+			PScene->simulate(StepInterval);
+			Next = Now();
+			Timings.Simulate += Next - Start;
+			Start = Next;
+			PScene->fetchResults(true);
+			Next = Now();
+			Timings.FetchResults += Next - Start;
+			if (Scene.bRecordTelemetry) Broadphase.Update(PScene);
+		}
+		if (Scene.bRecordTelemetry)
+		{
+			const PhysFrameActivity Activity = PhysGetFrameActivity(PScene, Bodies, Broadphase);
+			auto& Telemetry = OutResult.Telemetry[i];
+			Telemetry.SimulateTime = static_cast<float>(Timings.Simulate + Timings.FetchResults - FrameSimulateStart);
+			Telemetry.AwakeBodies = Activity.AwakeBodies;
+			Telemetry.ContactPairs = Activity.ContactPairs;
+			Telemetry.NarrowphasePairs = Activity.NarrowphasePairs;
+			Telemetry.BroadphasePairs = Activity.BroadphasePairs;
+			Telemetry.Events = NumOfEvents;
+		}
+
+		if (Scene.bRecordImpacts)
+		{
+			ImpactOrder.clear();
+			for (int j = 0; j < static_cast<int>(Contacts.Pending.size()); j++)
+			{
+				ImpactOrder.emplace_back(GetHash(Contacts.Pending[j].Location, Scene.HashWorldCenter, Scene.HashCellSize), j);
+			}
+			std::sort(ImpactOrder.begin(), ImpactOrder.end());
+			for (const auto& Entry : ImpactOrder)
+			{
+				OutResult.Impacts.push_back(Contacts.Pending[Entry.second]);
+			}
+			OutResult.ImpactFrameStarts.push_back(static_cast<int32_t>(OutResult.Impacts.size()));
+			Contacts.Pending.clear();
+		}
+		if (Scene.bRecordIslands)
+		{
+			PhysFindIslands(Contacts, NumOfBodies, IslandParents, &OutResult.Islands[static_cast<size_t>(i) * NumOfBodies]);
+		}
+		Start = Next;
+		Next = Now();
+		Timings.Contacts += Next - Start;
+
+		for (int j = 0; j < NumOfBodies; j++)
+		{
+			OutResult.Poses[static_cast<size_t>(i) * NumOfBodies + j] = FromPx(Bodies[j]->getGlobalPose());
+		}
+		if (Scene.bRecordStateHashes)
+		{
+			OutResult.FrameHashes[i] = HashPoses(&OutResult.Poses[static_cast<size_t>(i) * NumOfBodies], NumOfBodies);
+		}
+		Start = Next;
+		Next = Now();
+		Timings.Readback += Next - Start;
+
+		if (Scene.bEnableSOD)
+		{
+			for (int j = 0; j < NumOfBodies; j++)
+			{
+				const auto Bounds = Bodies[j]->getWorldBounds();
+				uint64_t* Hashes = &OutResult.Hashes[(static_cast<size_t>(i) * NumOfBodies + j) * 2];
+				Hashes[0] = GetHash(Bounds.minimum, Scene.HashWorldCenter, Scene.HashCellSize);
+				Hashes[1] = GetHash(Bounds.maximum, Scene.HashWorldCenter, Scene.HashCellSize);
+			}
+			Timings.Hashing += Now() - Next;
+		}
+	}
+
+	for (const auto Actor : Actors)
+	{
+		Actor->release();
+	}
+	PScene->release();
+	return true;
+}
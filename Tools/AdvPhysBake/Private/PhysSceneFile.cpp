@@ -0,0 +1,212 @@
+#include "PhysSceneFile.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#define SCENE_FILE_VERSION 2
+
+// Bounds checked reads of the little-endian file, sticky on failure like FArchive errors
+struct SceneFileReader
+{
+	const std::vector<char>& Bytes;
+	size_t Cursor = 0;
+	bool bError = false;
+
+	void Read(void* Out, size_t Size)
+	{
+		if (bError || Size > Bytes.size() - Cursor)
+		{
+			bError = true;
+			std::memset(Out, 0, Size);
+			return;
+		}
+		std::memcpy(Out, Bytes.data() + Cursor, Size);
+		Cursor += Size;
+	}
+
+	template <typename T>
+	T Read()
+	{
+		T Value;
+		Read(&Value, sizeof(T));
+		return Value;
+	}
+
+	bool ReadBool() { return Read<uint8_t>() != 0; }
+
+	// Counts of elements that cannot fit in the rest of the file fail before anything is allocated
+	uint32_t ReadCount(size_t MinElementSize)
+	{
+		const uint32_t Count = Read<uint32_t>();
+		if (static_cast<uint64_t>(Count) * MinElementSize > Bytes.size() - Cursor) bError = true;
+		return bError ? 0 : Count;
+	}
+
+	std::string ReadString()
+	{
+		const uint32_t Length = ReadCount(1);
+		std::string Value(Length, '\0');
+		Read(&Value[0], Length);
+		return Value;
+	}
+
+	PhysVec3 ReadVec3()
+	{
+		PhysVec3 Value;
+		Value.X = Read<float>();
+		Value.Y = Read<float>();
+		Value.Z = Read<float>();
+		return Value;
+	}
+
+	PhysPose ReadPose()
+	{
+		PhysPose Pose;
+		Pose.Position = ReadVec3();
+		Pose.Rotation.X = Read<float>();
+		Pose.Rotation.Y = Read<float>();
+		Pose.Rotation.Z = Read<float>();
+		Pose.Rotation.W = Read<float>();
+		return Pose;
+	}
+};
+
+const std::string* PhysEventData::FindProperty(const char* Name) const
+{
+	for (const auto& Property : Properties)
+	{
+		if (Property.first == Name) return &Property.second;
+	}
+	return nullptr;
+}
+
+float PhysEventData::GetFloat(const char* Name, float Default) const
+{
+	const auto Value = FindProperty(Name);
+	return Value ? std::strtof(Value->c_str(), nullptr) : Default;
+}
+
+static void ReadShape(SceneFileReader& Reader, PhysShapeData& Shape)
+{
+	Shape.Type = static_cast<PhysShapeType>(Reader.Read<uint8_t>());
+	Shape.Params = Reader.ReadVec3();
+	Shape.LocalPose = Reader.ReadPose();
+	Shape.Scale = Reader.ReadVec3();
+	Shape.StaticFriction = Reader.Read<float>();
+	Shape.DynamicFriction = Reader.Read<float>();
+	Shape.Restitution = Reader.Read<float>();
+
+	Shape.Vertices.resize(Reader.ReadCount(sizeof(PhysVec3)));
+	Reader.Read(Shape.Vertices.data(), Shape.Vertices.size() * sizeof(PhysVec3));
+	Shape.Indices.resize(Reader.ReadCount(sizeof(uint32_t)));
+	Reader.Read(Shape.Indices.data(), Shape.Indices.size() * sizeof(uint32_t));
+}
+
+static void ReadBody(SceneFileReader& Reader, PhysBodyData& Body)
+{
+	Body.bDynamic = Reader.ReadBool();
+	Body.Pose = Reader.ReadPose();
+	Body.Mass = Reader.Read<float>();
+	Body.LinearVelocity = Reader.ReadVec3();
+	Body.AngularVelocity = Reader.ReadVec3();
+	Body.Shapes.resize(Reader.ReadCount(1));
+	for (auto& Shape : Body.Shapes)
+	{
+		ReadShape(Reader, Shape);
+	}
+}
+
+static void ReadEvent(SceneFileReader& Reader, PhysEventData& Event)
+{
+	Event.Class = Reader.ReadString();
+	Event.Pose = Reader.ReadPose();
+	Event.Properties.resize(Reader.ReadCount(2 * sizeof(uint32_t)));
+	for (auto& Property : Event.Properties)
+	{
+		Property.first = Reader.ReadString();
+		Property.second = Reader.ReadString();
+	}
+}
+
+bool LoadPhysSceneFile(const std::string& Path, PhysSceneData& OutScene, std::string& OutError)
+{
+	std::ifstream File(Path, std::ios::binary);
+	if (!File)
+	{
+		OutError = "Could not open " + Path;
+		return false;
+	}
+	const std::vector<char> Bytes((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+	SceneFileReader Reader { Bytes };
+
+	char Magic[4];
+	Reader.Read(Magic, sizeof(Magic));
+	const uint32_t Version = Reader.Read<uint32_t>();
+	if (Reader.bError || std::memcmp(Magic, "APSF", sizeof(Magic)) != 0 || Version != SCENE_FILE_VERSION)
+	{
+		OutError = "Not a version " + std::to_string(SCENE_FILE_VERSION) + " scene file";
+		return false;
+	}
+
+	OutScene.FrameInterval = Reader.Read<float>();
+	OutScene.FrameCount = Reader.Read<int32_t>();
+	OutScene.GravityZ = Reader.Read<float>();
+
+	OutScene.bEnableSOD = Reader.ReadBool();
+	OutScene.Origin = Reader.ReadPose();
+	for (double& Coord : OutScene.HashWorldCenter)
+	{
+		Coord = Reader.Read<double>();
+	}
+	OutScene.HashCellSize = Reader.Read<float>();
+	OutScene.ObjectIds.resize(Reader.ReadCount(sizeof(uint32_t)));
+	for (auto& Id : OutScene.ObjectIds)
+	{
+		Id = Reader.ReadString();
+	}
+
+	OutScene.bRecordImpacts = Reader.ReadBool();
+	OutScene.ImpactImpulseThreshold = Reader.Read<float>();
+	OutScene.bRecordIslands = Reader.ReadBool();
+
+	auto& Profile = OutScene.Profile;
+	Profile.bMultiBoxPruning = Reader.Read<uint8_t>() == 1;
+	for (double& Coord : Profile.WorldBoundsMin)
+	{
+		Coord = Reader.Read<double>();
+	}
+	for (double& Coord : Profile.WorldBoundsMax)
+	{
+		Coord = Reader.Read<double>();
+	}
+	Profile.MBPSubdivisions = Reader.Read<int32_t>();
+	Profile.bEnablePCM = Reader.ReadBool();
+	Profile.bEnableStabilization = Reader.ReadBool();
+	Profile.bEnableCCD = Reader.ReadBool();
+	Profile.PositionIterations = Reader.Read<int32_t>();
+	Profile.VelocityIterations = Reader.Read<int32_t>();
+	Profile.SleepThreshold = Reader.Read<float>();
+	OutScene.bRecordTelemetry = Reader.ReadBool();
+	OutScene.bRecordStateHashes = Reader.ReadBool();
+	OutScene.bDeterministic = Reader.ReadBool();
+
+	OutScene.Bodies.resize(Reader.ReadCount(1));
+	for (auto& Body : OutScene.Bodies)
+	{
+		ReadBody(Reader, Body);
+	}
+	OutScene.Events.resize(Reader.ReadCount(1));
+	for (auto& Event : OutScene.Events)
+	{
+		ReadEvent(Reader, Event);
+	}
+
+	if (Reader.bError)
+	{
+		OutError = "Truncated or corrupt scene file";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "PhysSceneFile.h"
+
+#include <PxPhysicsAPI.h>
+#include "PhysRecordCore.h"
+
+// Seconds spent in each phase of a bake
+struct PhysBakeTimings
+{
+	double Build = 0.0;
+	double Events = 0.0;
+	double Simulate = 0.0;
+	double FetchResults = 0.0;
+	double Contacts = 0.0;
+	double Readback = 0.0;
+	double Hashing = 0.0;
+};
+
+// FPhysFrameTelemetry of the game module
+struct PhysFrameTelemetry
+{
+	float SimulateTime = 0.0f;
+	int32_t AwakeBodies = 0;
+	int32_t ContactPairs = 0;
+	int32_t NarrowphasePairs = 0;
+	int32_t BroadphasePairs = 0;
+	int32_t Events = 0;
+};
+
+struct PhysBakeResult
+{
+	int32_t FrameCount = 0;
+	int32_t ObjectCount = 0;
+	float FrameInterval = 0.0f;
+	// Per frame and object
+	std::vector<PhysPose> Poses;
+	// Start and end Morton hash of the bounds per frame and object, empty without SOD
+	std::vector<uint64_t> Hashes;
+	// Lowest object index of the contact island per frame and object, empty if not recorded
+	std::vector<int32_t> Islands;
+	// One entry per frame if the scene asked for telemetry
+	std::vector<PhysFrameTelemetry> Telemetry;
+	// Hash of the poses per frame if the scene asked for state hashes
+	std::vector<uint64_t> FrameHashes;
+	// Impacts by frame in Morton order of their location, as FPhysRecordData stores them.
+	// Impacts of frame i are Impacts[ImpactFrameStarts[i]] up to Impacts[ImpactFrameStarts[i + 1]], empty if not recorded.
+	std::vector<PhysImpact> Impacts;
+	std::vector<int32_t> ImpactFrameStarts;
+	PhysBakeTimings Timings;
+};
+
+// The record loop of PhysSimulator with nothing but PhysX, for baking and profiling outside of Unreal.
+// Scene settings, contacts, islands and telemetry come from PhysRecordCore.h, which PhysSimulator uses as well.
+// Events are replayed for explosions and force fields, found by their properties; other events are skipped.
+class PhysBaker
+{
+public:
+	explicit PhysBaker(int DispatcherThreads);
+	~PhysBaker();
+
+	bool IsValid() const { return Physics != nullptr && Cooking != nullptr; }
+	// Force fields apply on every one of the Substeps simulation steps per frame
+	bool Bake(const PhysSceneData& Scene, int Substeps, PhysBakeResult& OutResult, std::string& OutError);
+
+private:
+	physx::PxShape* CreateShape(const PhysShapeData& Data);
+
+	physx::PxDefaultAllocator Allocator;
+	physx::PxDefaultErrorCallback ErrorCallback;
+	physx::PxFoundation* Foundation = nullptr;
+	physx::PxPhysics* Physics = nullptr;
+	physx::PxCooking* Cooking = nullptr;
+	physx::PxDefaultCpuDispatcher* Dispatcher = nullptr;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Reader of the scene files written by AdvPhysSceneFile, see AdvPhysSceneFile.h in the game module for the layout
+
+struct PhysVec3
+{
+	float X = 0.0f, Y = 0.0f, Z = 0.0f;
+};
+
+struct PhysQuat
+{
+	float X = 0.0f, Y = 0.0f, Z = 0.0f, W = 1.0f;
+};
+
+struct PhysPose
+{
+	PhysVec3 Position;
+	PhysQuat Rotation;
+};
+
+enum class PhysShapeType : uint8_t
+{
+	Sphere,
+	Capsule,
+	Box,
+	Convex,
+	TriMesh
+};
+
+struct PhysShapeData
+{
+	PhysShapeType Type = PhysShapeType::Sphere;
+	PhysVec3 Params;
+	PhysPose LocalPose;
+	PhysVec3 Scale;
+	float StaticFriction = 0.0f;
+	float DynamicFriction = 0.0f;
+	float Restitution = 0.0f;
+	std::vector<PhysVec3> Vertices;
+	std::vector<uint32_t> Indices;
+};
+
+struct PhysBodyData
+{
+	bool bDynamic = false;
+	PhysPose Pose;
+	float Mass = 0.0f;
+	PhysVec3 LinearVelocity;
+	PhysVec3 AngularVelocity;
+	std::vector<PhysShapeData> Shapes;
+};
+
+struct PhysEventData
+{
+	std::string Class;
+	PhysPose Pose;
+	std::vector<std::pair<std::string, std::string>> Properties;
+
+	const std::string* FindProperty(const char* Name) const;
+	float GetFloat(const char* Name, float Default) const;
+};
+
+// FPhysBakeProfile without its PVD settings
+struct PhysProfileData
+{
+	bool bMultiBoxPruning = false;
+	double WorldBoundsMin[3] = { -100000.0, -100000.0, -100000.0 };
+	double WorldBoundsMax[3] = { 100000.0, 100000.0, 100000.0 };
+	int32_t MBPSubdivisions = 4;
+	bool bEnablePCM = true;
+	bool bEnableStabilization = false;
+	bool bEnableCCD = false;
+	int32_t PositionIterations = 4;
+	int32_t VelocityIterations = 1;
+	float SleepThreshold = -1.0f;
+};
+
+struct PhysSceneData
+{
+	float FrameInterval = 0.0f;
+	int32_t FrameCount = 0;
+	float GravityZ = 0.0f;
+
+	bool bEnableSOD = false;
+	PhysPose Origin;
+	double HashWorldCenter[3] = { 0.0, 0.0, 0.0 };
+	float HashCellSize = 0.0f;
+	std::vector<std::string> ObjectIds;
+
+	bool bRecordImpacts = false;
+	float ImpactImpulseThreshold = 0.0f;
+	bool bRecordIslands = false;
+	PhysProfileData Profile;
+	bool bRecordTelemetry = false;
+	bool bRecordStateHashes = false;
+	bool bDeterministic = false;
+
+	std::vector<PhysBodyData> Bodies;
+	std::vector<PhysEventData> Events;
+};
+
+bool LoadPhysSceneFile(const std::string& Path, PhysSceneData& OutScene, std::string& OutError);